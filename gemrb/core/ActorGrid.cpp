@@ -0,0 +1,139 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "ActorGrid.h"
+
+#include "Scriptable/Actor.h"
+
+#include <algorithm>
+
+namespace GemRB {
+
+const int ActorGrid::CELL_SIZE;
+
+ActorGrid::ActorGrid()
+	: cellCount(1, 1), cells(1)
+{
+}
+
+void ActorGrid::Resize(const Size &navmapSize)
+{
+	cellCount.w = std::max(1, (navmapSize.w + CELL_SIZE - 1) / CELL_SIZE);
+	cellCount.h = std::max(1, (navmapSize.h + CELL_SIZE - 1) / CELL_SIZE);
+
+	std::vector<Slot> all;
+	for (const auto &cell : cells) {
+		all.insert(all.end(), cell.begin(), cell.end());
+	}
+	cells.assign(cellCount.Area(), std::vector<Slot>());
+	// keep the serials, so the ordering survives
+	std::sort(all.begin(), all.end());
+	for (const Slot &slot : all) {
+		size_t idx = CellIndex(slot.second->Pos);
+		cells[idx].push_back(slot);
+		entries[slot.second].cell = idx;
+	}
+}
+
+size_t ActorGrid::CellIndex(const Point &p) const
+{
+	// anything outside the map is kept in the border cells
+	int x = Clamp(p.x / CELL_SIZE, 0, cellCount.w - 1);
+	int y = Clamp(p.y / CELL_SIZE, 0, cellCount.h - 1);
+	return y * cellCount.w + x;
+}
+
+void ActorGrid::Insert(Actor *actor)
+{
+	if (Contains(actor)) {
+		Update(actor);
+		return;
+	}
+
+	size_t idx = CellIndex(actor->Pos);
+	unsigned long serial = nextSerial++;
+	entries[actor] = { idx, serial };
+	// serials only grow, so the cell stays sorted
+	cells[idx].emplace_back(serial, actor);
+	maxSize = std::max(maxSize, int(actor->size));
+}
+
+Actor *ActorGrid::Unlink(size_t cell, const Actor *actor)
+{
+	std::vector<Slot> &slots = cells[cell];
+	for (auto it = slots.begin(); it != slots.end(); ++it) {
+		if (it->second == actor) {
+			Actor *found = it->second;
+			slots.erase(it);
+			return found;
+		}
+	}
+	return nullptr;
+}
+
+void ActorGrid::Remove(const Actor *actor)
+{
+	auto it = entries.find(actor);
+	if (it == entries.end()) return;
+
+	Unlink(it->second.cell, actor);
+	entries.erase(it);
+}
+
+void ActorGrid::Update(const Actor *actor)
+{
+	auto it = entries.find(actor);
+	if (it == entries.end()) return;
+
+	maxSize = std::max(maxSize, int(actor->size));
+	Entry &entry = it->second;
+	size_t idx = CellIndex(actor->Pos);
+	if (idx == entry.cell) return;
+
+	std::vector<Slot> &slots = cells[idx];
+	Slot slot(entry.serial, Unlink(entry.cell, actor));
+	slots.insert(std::upper_bound(slots.begin(), slots.end(), slot), slot);
+	entry.cell = idx;
+}
+
+void ActorGrid::Query(const Region &rgn, std::vector<Actor *> &result) const
+{
+	int x1 = Clamp(rgn.x / CELL_SIZE, 0, cellCount.w - 1);
+	int y1 = Clamp(rgn.y / CELL_SIZE, 0, cellCount.h - 1);
+	int x2 = Clamp((rgn.x + rgn.w) / CELL_SIZE, 0, cellCount.w - 1);
+	int y2 = Clamp((rgn.y + rgn.h) / CELL_SIZE, 0, cellCount.h - 1);
+
+	std::vector<Slot> found;
+	for (int y = y1; y <= y2; y++) {
+		for (int x = x1; x <= x2; x++) {
+			const std::vector<Slot> &slots = cells[y * cellCount.w + x];
+			found.insert(found.end(), slots.begin(), slots.end());
+		}
+	}
+	std::sort(found.begin(), found.end());
+
+	result.clear();
+	result.reserve(found.size());
+	for (const Slot &slot : found) {
+		result.push_back(slot.second);
+	}
+}
+
+}
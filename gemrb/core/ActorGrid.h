@@ -0,0 +1,76 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef ACTORGRID_H
+#define ACTORGRID_H
+
+#include "Region.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace GemRB {
+
+class Actor;
+
+// Uniform grid over the navmap bucketing the actors of an area by position,
+// so that point, radius and rectangle lookups only look at nearby actors.
+// Candidates are always returned in the order the actors were added in,
+// which matches the order of the area's actor list.
+class ActorGrid {
+public:
+	static const int CELL_SIZE = 128;
+
+	ActorGrid();
+
+	// sets the covered area in navmap coordinates and rebuckets everyone
+	void Resize(const Size &navmapSize);
+	void Insert(Actor *actor);
+	void Remove(const Actor *actor);
+	// call when the actor's position or size may have changed
+	void Update(const Actor *actor);
+	bool Contains(const Actor *actor) const { return entries.count(actor) != 0; }
+
+	// collects the actors standing in the cells overlapping rgn;
+	// callers still need to do their own exact checks
+	void Query(const Region &rgn, std::vector<Actor *> &result) const;
+	// the biggest circle size seen so far, for padding queries
+	int MaxActorSize() const { return maxSize; }
+
+private:
+	struct Entry {
+		size_t cell;
+		unsigned long serial;
+	};
+	typedef std::pair<unsigned long, Actor *> Slot;
+
+	size_t CellIndex(const Point &p) const;
+	Actor *Unlink(size_t cell, const Actor *actor);
+
+	Size cellCount;
+	std::vector<std::vector<Slot>> cells;
+	std::unordered_map<const Actor *, Entry> entries;
+	unsigned long nextSerial = 0;
+	int maxSize = 0;
+};
+
+}
+
+#endif
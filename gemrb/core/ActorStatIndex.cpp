@@ -0,0 +1,126 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "ActorStatIndex.h"
+
+#include "ie_stats.h"
+
+#include "Scriptable/Actor.h"
+
+#include <algorithm>
+
+namespace GemRB {
+
+const int ActorStatIndex::STAT_COUNT;
+
+// class is missing on purpose, since its matching depends on the levels
+// and dual-classing too, not just on IE_CLASS
+const unsigned int ActorStatIndex::indexedStats[STAT_COUNT] = {
+	IE_EA, IE_GENERAL, IE_RACE, IE_SPECIFIC, IE_SEX, IE_ALIGNMENT
+};
+
+int ActorStatIndex::StatSlot(unsigned int stat)
+{
+	for (int slot = 0; slot < STAT_COUNT; ++slot) {
+		if (indexedStats[slot] == stat) return slot;
+	}
+	return -1;
+}
+
+void ActorStatIndex::Insert(Actor *actor)
+{
+	if (entries.count(actor)) {
+		Update(actor);
+		return;
+	}
+
+	Entry &entry = entries[actor];
+	entry.serial = nextSerial++;
+	for (int slot = 0; slot < STAT_COUNT; ++slot) {
+		entry.keys[slot] = actor->GetStat(indexedStats[slot]);
+		// serials only grow, so the bucket stays sorted
+		buckets[slot][entry.keys[slot]].emplace_back(entry.serial, actor);
+	}
+}
+
+void ActorStatIndex::Unlink(int slot, ieDword key, const Actor *actor)
+{
+	auto bucket = buckets[slot].find(key);
+	if (bucket == buckets[slot].end()) return;
+
+	std::vector<Slot> &slots = bucket->second;
+	for (auto it = slots.begin(); it != slots.end(); ++it) {
+		if (it->second == actor) {
+			slots.erase(it);
+			break;
+		}
+	}
+	if (slots.empty()) {
+		buckets[slot].erase(bucket);
+	}
+}
+
+void ActorStatIndex::Remove(const Actor *actor)
+{
+	auto it = entries.find(actor);
+	if (it == entries.end()) return;
+
+	for (int slot = 0; slot < STAT_COUNT; ++slot) {
+		Unlink(slot, it->second.keys[slot], actor);
+	}
+	entries.erase(it);
+}
+
+void ActorStatIndex::Update(const Actor *actor)
+{
+	auto it = entries.find(actor);
+	if (it == entries.end()) return;
+
+	Entry &entry = it->second;
+	for (int slot = 0; slot < STAT_COUNT; ++slot) {
+		ieDword key = actor->GetStat(indexedStats[slot]);
+		if (key == entry.keys[slot]) continue;
+
+		Unlink(slot, entry.keys[slot], actor);
+		std::vector<Slot> &slots = buckets[slot][key];
+		Slot moved(entry.serial, const_cast<Actor *>(actor));
+		slots.insert(std::upper_bound(slots.begin(), slots.end(), moved), moved);
+		entry.keys[slot] = key;
+	}
+}
+
+void ActorStatIndex::Query(int slot, const Matcher &match, std::vector<Actor *> &result) const
+{
+	std::vector<Slot> found;
+	for (const auto &bucket : buckets[slot]) {
+		if (match(bucket.second.front().second)) {
+			found.insert(found.end(), bucket.second.begin(), bucket.second.end());
+		}
+	}
+	std::sort(found.begin(), found.end());
+
+	result.clear();
+	result.reserve(found.size());
+	for (const Slot &s : found) {
+		result.push_back(s.second);
+	}
+}
+
+}
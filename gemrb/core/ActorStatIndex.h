@@ -0,0 +1,75 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef ACTORSTATINDEX_H
+#define ACTORSTATINDEX_H
+
+#include "ie_types.h"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace GemRB {
+
+class Actor;
+
+// Buckets the actors of an area by the values of the stats used in
+// IDS object matching ([PC], [0.0.DOG], ...), so scripts only need to look
+// at the actors that can possibly match instead of everyone in the area.
+// Like with ActorGrid, results keep the order of the area's actor list.
+class ActorStatIndex {
+public:
+	// matches a whole bucket, by looking at one of its actors; this is only
+	// correct for checks depending on nothing but the value of the stat
+	using Matcher = std::function<bool(const Actor *representative)>;
+
+	// the index of the stat in the table of indexed stats or -1
+	static int StatSlot(unsigned int stat);
+
+	void Insert(Actor *actor);
+	void Remove(const Actor *actor);
+	// call when any of the indexed stats may have changed
+	void Update(const Actor *actor);
+
+	// collects the actors in buckets of the stat that pass match
+	void Query(int slot, const Matcher &match, std::vector<Actor *> &result) const;
+
+private:
+	static const int STAT_COUNT = 6;
+	static const unsigned int indexedStats[STAT_COUNT];
+
+	struct Entry {
+		unsigned long serial;
+		ieDword keys[STAT_COUNT];
+	};
+	typedef std::pair<unsigned long, Actor *> Slot;
+	typedef std::unordered_map<ieDword, std::vector<Slot>> Buckets;
+
+	void Unlink(int slot, ieDword key, const Actor *actor);
+
+	Buckets buckets[STAT_COUNT];
+	std::unordered_map<const Actor *, Entry> entries;
+	unsigned long nextSerial = 0;
+};
+
+}
+
+#endif
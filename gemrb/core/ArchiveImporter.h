@@ -26,6 +26,9 @@
 #include "Plugin.h"
 #include "SaveGameAREExtractor.h"
 
+#include <string>
+#include <vector>
+
 namespace GemRB {
 
 class GEM_EXPORT ArchiveImporter : public Plugin {
@@ -34,6 +37,8 @@ public:
 	//decompressing a .sav file similar to CBF
 	virtual int DecompressSaveGame(DataStream *compressed, SaveGameAREExtractor&) = 0;
 	virtual int AddToSaveGame(DataStream *str, DataStream *uncompressed) = 0;
+	//compresses the files side by side, but adds them in the given order
+	virtual int AddFilesToSaveGame(DataStream *str, const std::vector<std::string>& paths, int level) = 0;
 	virtual int AddToSaveGameCompressed(DataStream *str, DataStream *compressed) = 0;
 };
 
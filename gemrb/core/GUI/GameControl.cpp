@@ -94,7 +94,6 @@ GameControl::GameControl(const Region& frame)
 	overDoor = NULL;
 	overContainer = NULL;
 	overInfoPoint = NULL;
-	drawPath = NULL;
 	lastCursor = IE_CURSOR_INVALID;
 	numScrollCursor = 0;
 
@@ -625,21 +624,18 @@ void GameControl::DrawSelf(Region screen, const Region& /*clip*/)
 	}
 
 	// Draw path
-	if (drawPath) {
-		PathNode* node = drawPath;
-		while (true) {
-			Point p( ( node-> x*16) + 8, ( node->y*12 ) + 6 );
-			if (!node->Parent) {
-				video->DrawCircle( p, 2, ColorRed );
-			} else {
-				short oldX = ( node->Parent-> x*16) + 8, oldY = ( node->Parent->y*12 ) + 6;
-				video->DrawLine( Point(oldX, oldY), p, ColorGreen );
-			}
-			if (!node->Next) {
-				video->DrawCircle( p, 2, ColorGreen );
-				break;
-			}
-			node = node->Next;
+	for (size_t i = 0; i < drawPath.size(); i++) {
+		const PathNode &node = drawPath[i];
+		Point p( ( node.x*16) + 8, ( node.y*12 ) + 6 );
+		if (i == 0) {
+			video->DrawCircle( p, 2, ColorRed );
+		} else {
+			const PathNode &parent = drawPath[i - 1];
+			short oldX = ( parent.x*16) + 8, oldY = ( parent.y*12 ) + 6;
+			video->DrawLine( Point(oldX, oldY), p, ColorGreen );
+		}
+		if (i == drawPath.size() - 1) {
+			video->DrawCircle( p, 2, ColorGreen );
 		}
 	}
 
@@ -99,7 +99,7 @@ private:
 	int lastCursor;
 	Point vpVector;
 	int numScrollCursor;
-	PathNode* drawPath;
+	Path drawPath;
 	unsigned int ScreenFlags;
 	unsigned int DialogueFlags;
 	String* DisplayText;
@@ -919,12 +919,7 @@ int Game::LoadMap(const char* ResRef, bool loadscreen)
 		sE->RunFunction("LoadScreen", "SetLoadScreen");
 	}
 
-	DataStream* ds = nullptr;
-	if (core->saveGameAREExtractor.extractARE(ResRef) != GEM_OK) {
-		goto failedload;
-	}
-
-	ds = gamedata->GetResource( ResRef, IE_ARE_CLASS_ID );
+	DataStream* ds = gamedata->GetResource( ResRef, IE_ARE_CLASS_ID );
 	if (!ds) {
 		goto failedload;
 	}
@@ -785,7 +785,7 @@ static Point FindOffScreenPoint(const Scriptable *Sender, int flags, int creatur
 			}
 
 			// Check if walkableStartPoint can traverse to walkableGoal
-			bool isWalkable = map->FindPath(walkableStartPoint, walkableGoal, creatureSize) != nullptr;
+			bool isWalkable = !map->TargetUnreachable(walkableStartPoint, walkableGoal, creatureSize, false);
 
 			if (isPassable && (!(flags & CC_OBJECT) || isWalkable)) {
 				// walkableStartPoint is the final point
@@ -1989,7 +1989,7 @@ bool IsInObjectRect(const Point &pos, const Region &rect)
 
 #define MEMCPY(a,b) memcpy((a),(b),sizeof(a) )
 
-static Object *ObjectCopy(Object *object)
+static Object *ObjectCopy(const Object *object)
 {
 	if (!object) return NULL;
 	Object *newObject = new Object();
@@ -2032,6 +2032,21 @@ Action *ParamCopyNoOverride(Action *parameters)
 	return newAction;
 }
 
+Trigger *TriggerCopy(const Trigger *parameters)
+{
+	Trigger *newTrigger = new Trigger();
+	newTrigger->triggerID = parameters->triggerID;
+	newTrigger->flags = parameters->flags;
+	newTrigger->int0Parameter = parameters->int0Parameter;
+	newTrigger->int1Parameter = parameters->int1Parameter;
+	newTrigger->int2Parameter = parameters->int2Parameter;
+	newTrigger->pointParameter = parameters->pointParameter;
+	MEMCPY( newTrigger->string0Parameter, parameters->string0Parameter );
+	MEMCPY( newTrigger->string1Parameter, parameters->string1Parameter );
+	newTrigger->objectParameter = ObjectCopy( parameters->objectParameter );
+	return newTrigger;
+}
+
 Trigger *GenerateTriggerCore(const char *src, const char *str, int trIndex, int negate)
 {
 	Trigger *newTrigger = new Trigger();
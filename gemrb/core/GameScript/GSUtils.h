@@ -116,6 +116,7 @@ GEM_EXPORT SrcVector *LoadSrc(const ResRef& resname);
 bool IsInObjectRect(const Point &pos, const Region &rect);
 Action *ParamCopy(Action *parameters);
 Action *ParamCopyNoOverride(Action *parameters);
+Trigger *TriggerCopy(const Trigger *parameters);
 GEM_EXPORT void SetVariable(Scriptable* Sender, const char* VarName, ieDword value, const char* Context = nullptr);
 GEM_EXPORT void SetPointVariable(Scriptable* Sender, const char* VarName, const Point &point, const char* Context = nullptr);
 Point GetEntryPoint(const char *areaname, const char *entryname);
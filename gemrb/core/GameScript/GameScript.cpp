@@ -53,7 +53,9 @@
 #include "RNG.h"
 #include "System/StringBuffer.h"
 
+#include <algorithm>
 #include <cstdarg>
+#include <unordered_map>
 
 namespace GemRB {
 
@@ -1176,52 +1178,58 @@ static const IDSLink idsnames[] = {
 
 static int NextTriggerObjectID = 0;
 
-static const TriggerLink* FindTrigger(const char* triggername)
+static std::string LowerPrefix(const char *str, int len)
+{
+	std::string key(str, len);
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	return key;
+}
+
+// a trigger or action name up to and including the opening parenthesis, if any
+static std::string CallKey(const char *str)
 {
-	if (!triggername) {
+	int len = strlench(str, '(');
+	if (str[len] == '(') len++;
+	return LowerPrefix(str, len);
+}
+
+// case insensitive name -> link lookup, the first link of a name wins
+template <class Link>
+static const Link* FindLink(const Link *links, std::unordered_map<std::string, const Link*> &index, const char *name)
+{
+	if (!name) {
 		return NULL;
 	}
-	int len = strlench( triggername, '(' );
-	for (int i = 0; triggernames[i].Name; i++) {
-		if (!strnicmp( triggernames[i].Name, triggername, len )) {
-			if (!triggernames[i].Name[len]) {
-				return triggernames + i;
-			}
+	if (index.empty()) {
+		for (int i = 0; links[i].Name; i++) {
+			index.emplace(LowerPrefix(links[i].Name, strlench(links[i].Name, '(')), links + i);
 		}
 	}
-	return NULL;
+	auto it = index.find(LowerPrefix(name, strlench(name, '(')));
+	if (it == index.end()) {
+		return NULL;
+	}
+	return it->second;
+}
+
+static std::unordered_map<std::string, const TriggerLink*> triggerLinks;
+static std::unordered_map<std::string, const ActionLink*> actionLinks;
+static std::unordered_map<std::string, const ObjectLink*> objectLinks;
+static std::unordered_map<std::string, const IDSLink*> idsLinks;
+
+static const TriggerLink* FindTrigger(const char* triggername)
+{
+	return FindLink(triggernames, triggerLinks, triggername);
 }
 
 static const ActionLink* FindAction(const char* actionname)
 {
-	if (!actionname) {
-		return NULL;
-	}
-	int len = strlench( actionname, '(' );
-	for (int i = 0; actionnames[i].Name; i++) {
-		if (!strnicmp( actionnames[i].Name, actionname, len )) {
-			if (!actionnames[i].Name[len]) {
-				return actionnames + i;
-			}
-		}
-	}
-	return NULL;
+	return FindLink(actionnames, actionLinks, actionname);
 }
 
 static const ObjectLink* FindObject(const char* objectname)
 {
-	if (!objectname) {
-		return NULL;
-	}
-	int len = strlench( objectname, '(' );
-	for (int i = 0; objectnames[i].Name; i++) {
-		if (!strnicmp( objectnames[i].Name, objectname, len )) {
-			if (!objectnames[i].Name[len]) {
-				return objectnames + i;
-			}
-		}
-	}
-	return NULL;
+	return FindLink(objectnames, objectLinks, objectname);
 }
 
 static const IDSLink* FindIdentifier(const char* idsname)
@@ -1229,15 +1237,21 @@ static const IDSLink* FindIdentifier(const char* idsname)
 	if (!idsname) {
 		return NULL;
 	}
-	int len = (int)strlen( idsname );
-	for (int i = 0; idsnames[i].Name; i++) {
-		if (!strnicmp( idsnames[i].Name, idsname, len )) {
-			return idsnames + i;
+	// abbreviations are fine too, so every prefix of a name is a key
+	if (idsLinks.empty()) {
+		for (int i = 0; idsnames[i].Name; i++) {
+			std::string name = LowerPrefix(idsnames[i].Name, (int) strlen(idsnames[i].Name));
+			for (size_t len = 0; len <= name.size(); len++) {
+				idsLinks.emplace(name.substr(0, len), idsnames + i);
+			}
 		}
 	}
-	
-	Log(WARNING, "GameScript", "Couldn't assign ids target: %.*s",
-		len, idsname );
+	auto it = idsLinks.find(LowerPrefix(idsname, (int) strlen(idsname)));
+	if (it != idsLinks.end()) {
+		return it->second;
+	}
+
+	Log(WARNING, "GameScript", "Couldn't assign ids target: %s", idsname);
 	return NULL;
 }
 
@@ -1253,6 +1267,58 @@ void ScriptDebugLog(int bit, const char *message, ...)
 
 /********************** Targets **********************************/
 
+// scripts are only ever evaluated on the main thread
+static std::vector<void *> spareTargets;
+static std::vector<targetlist> spareTargetLists;
+static const size_t MAX_SPARE_TARGETS = 64;
+
+void *Targets::operator new(size_t size)
+{
+	if (size != sizeof(Targets) || spareTargets.empty()) {
+		return ::operator new(size);
+	}
+	void *ptr = spareTargets.back();
+	spareTargets.pop_back();
+	return ptr;
+}
+
+void Targets::operator delete(void *ptr)
+{
+	if (!ptr) return;
+	if (spareTargets.size() < MAX_SPARE_TARGETS) {
+		spareTargets.push_back(ptr);
+	} else {
+		::operator delete(ptr);
+	}
+}
+
+Targets::Targets()
+{
+	// take over the storage of an old list, so adding doesn't need to allocate
+	if (!spareTargetLists.empty()) {
+		objects.swap(spareTargetLists.back());
+		spareTargetLists.pop_back();
+	}
+}
+
+Targets::~Targets()
+{
+	Clear();
+	if (objects.capacity() && spareTargetLists.size() < MAX_SPARE_TARGETS) {
+		spareTargetLists.push_back(std::move(objects));
+	}
+}
+
+// same order as inserting each target before the first farther one
+void Targets::Sort() const
+{
+	if (sorted) return;
+	std::stable_sort(objects.begin(), objects.end(), [](const targettype &a, const targettype &b) {
+		return a.distance < b.distance;
+	});
+	sorted = true;
+}
+
 int Targets::Count() const
 {
 	return (int)objects.size();
@@ -1269,6 +1335,17 @@ targettype *Targets::RemoveTargetAt(targetlist::iterator &m)
 
 const targettype *Targets::GetLastTarget(int Type)
 {
+	if (!sorted) {
+		// the farthest one that was added last, no need to sort everything
+		const targettype *last = NULL;
+		for (const targettype &t : objects) {
+			if ((Type == -1 || t.actor->Type == Type) && (!last || t.distance >= last->distance)) {
+				last = &t;
+			}
+		}
+		return last;
+	}
+
 	targetlist::const_iterator m = objects.end();
 	while (m--!=objects.begin() ) {
 		if ( (Type==-1) || ((*m).actor->Type==Type) ) {
@@ -1280,6 +1357,7 @@ const targettype *Targets::GetLastTarget(int Type)
 
 const targettype *Targets::GetFirstTarget(targetlist::iterator &m, int Type)
 {
+	Sort();
 	m=objects.begin();
 	while (m!=objects.end() ) {
 		if ( (Type!=-1) && ( (*m).actor->Type!=Type)) {
@@ -1306,6 +1384,18 @@ const targettype *Targets::GetNextTarget(targetlist::iterator &m, int Type)
 
 Scriptable *Targets::GetTarget(unsigned int index, int Type)
 {
+	if (!sorted && !index) {
+		// the nearest one that was added first, no need to sort everything
+		const targettype *first = NULL;
+		for (const targettype &t : objects) {
+			if ((Type == -1 || t.actor->Type == Type) && (!first || t.distance < first->distance)) {
+				first = &t;
+			}
+		}
+		return first ? first->actor : NULL;
+	}
+
+	Sort();
 	targetlist::iterator m = objects.begin();
 	while(m!=objects.end() ) {
 		if ( (Type==-1) || ((*m).actor->Type==Type)) {
@@ -1342,24 +1432,21 @@ void Targets::AddTarget(Scriptable* target, unsigned int distance, int ga_flags)
 	default:
 		break;
 	}
-	targettype Target = {target, distance};
-	targetlist::iterator m;
-	for (m = objects.begin(); m != objects.end(); ++m) {
-		if ( (*m).distance>distance) {
-			objects.insert( m, Target);
-			return;
-		}
+	if (sorted && !objects.empty() && objects.back().distance > distance) {
+		sorted = false;
 	}
-	objects.push_back( Target );
+	objects.push_back({ target, distance });
 }
 
 void Targets::Clear()
 {
 	objects.clear();
+	sorted = true;
 }
 
 void Targets::dump() const
 {
+	Sort();
 	print("Target dump (actors only):");
 	targetlist::const_iterator m;
 	for (m = objects.begin(); m != objects.end(); ++m) {
@@ -1374,19 +1461,61 @@ void Targets::FilterObjectRect(const Object *oC)
 	// can't match anything if the second pair of coordinates (or all of them) are unset
 	if (oC->objectRect.w <= 0 || oC->objectRect.h <= 0) return;
 
-	targetlist::const_iterator m;
-	for (m = objects.begin(); m != objects.end();) {
-		if (!IsInObjectRect((*m).actor->Pos, oC->objectRect)) {
-			m = objects.erase(m);
-		} else {
-			++m;
-		}
+	objects.erase(std::remove_if(objects.begin(), objects.end(), [oC](const targettype &t) {
+		return !IsInObjectRect(t.actor->Pos, oC->objectRect);
+	}), objects.end());
+}
+
+/** symbol table lookups for compiling triggers and actions from text */
+typedef std::unordered_map<std::string, int> SymbolIndex;
+static SymbolIndex triggerSymbols;
+static SymbolIndex actionSymbols;
+static SymbolIndex overrideActionSymbols;
+
+// same as SymbolMgr::FindString, which returns the last match
+static void IndexSymbols(const Holder<SymbolMgr>& table, SymbolIndex &index)
+{
+	index.clear();
+	if (!table) return;
+	for (size_t i = 0; i < table->GetSize(); i++) {
+		index[CallKey(table->GetStringIndex(i))] = (int) i;
 	}
 }
 
+static int FindSymbol(const SymbolIndex &index, const char *str)
+{
+	auto it = index.find(CallKey(str));
+	if (it == index.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+/** dialogs and the ui compile the same strings over and over, so we keep
+ * the results and hand out copies; bounded, since some strings contain ids */
+static std::unordered_map<std::string, Action*> compiledActions;
+static std::unordered_map<std::string, Trigger*> compiledTriggers;
+static const size_t MAX_COMPILED_STRINGS = 1024;
+
+static void ClearCompiledStrings()
+{
+	for (auto& entry : compiledActions) {
+		entry.second->Release();
+	}
+	compiledActions.clear();
+	for (auto& entry : compiledTriggers) {
+		entry.second->Release();
+	}
+	compiledTriggers.clear();
+}
+
 /** releasing global memory */
 static void CleanupIEScript()
 {
+	ClearCompiledStrings();
+	triggerSymbols.clear();
+	actionSymbols.clear();
+	overrideActionSymbols.clear();
 	triggersTable.release();
 	actionsTable.release();
 	objectsTable.release();
@@ -1468,6 +1597,9 @@ void InitializeIEScript()
 	if (!triggersTable || !actionsTable || !objectsTable || !objNameTable) {
 		error("GameScript", "A critical scripting file is damaged!\n");
 	}
+	IndexSymbols(triggersTable, triggerSymbols);
+	IndexSymbols(actionsTable, actionSymbols);
+	IndexSymbols(overrideActionsTable, overrideActionSymbols);
 
 	/* Loading Script Configuration Parameters */
 
@@ -2524,13 +2656,19 @@ Trigger* GenerateTrigger(char* String)
 	strlwr( String );
 	ScriptDebugLog(ID_TRIGGERS, "Compiling: %s", String);
 
+	auto cached = compiledTriggers.find(String);
+	if (cached != compiledTriggers.end()) {
+		return TriggerCopy(cached->second);
+	}
+	std::string key = String;
+
 	int negate = 0;
 	if (*String == '!') {
 		String++;
 		negate = TF_NEGATE;
 	}
 	int len = strlench(String,'(')+1; //including (
-	int i = triggersTable->FindString(String, len);
+	int i = FindSymbol(triggerSymbols, String);
 	if (i<0) {
 		Log(ERROR, "GameScript", "Invalid scripting trigger: %s", String);
 		return NULL;
@@ -2542,6 +2680,10 @@ Trigger* GenerateTrigger(char* String)
 		Log(ERROR, "GameScript", "Malformed scripting trigger: %s", String);
 		return NULL;
 	}
+	if (compiledTriggers.size() >= MAX_COMPILED_STRINGS) {
+		ClearCompiledStrings();
+	}
+	compiledTriggers[key] = TriggerCopy(trigger);
 	return trigger;
 }
 
@@ -2553,20 +2695,26 @@ Action* GenerateAction(const char* String)
 	strlwr( actionString );
 	ScriptDebugLog(ID_ACTIONS, "Compiling: %s", String);
 
+	auto cached = compiledActions.find(actionString);
+	if (cached != compiledActions.end()) {
+		free(actionString);
+		return ParamCopy(cached->second);
+	}
+
 	int len = strlench(String,'(')+1; //including (
 	char *src = actionString+len;
 	int i = -1;
 	char *str;
 	unsigned short actionID;
 	if (overrideActionsTable) {
-		i = overrideActionsTable->FindString(actionString, len);
+		i = FindSymbol(overrideActionSymbols, actionString);
 		if (i >= 0) {
 			str = overrideActionsTable->GetStringIndex( i )+len;
 			actionID = overrideActionsTable->GetValueIndex(i);
 		}
 	}
 	if (i<0) {
-		i = actionsTable->FindString(actionString, len);
+		i = FindSymbol(actionSymbols, actionString);
 		if (i < 0) {
 			Log(ERROR, "GameScript", "Invalid scripting action: %s", String);
 			goto done;
@@ -2577,6 +2725,14 @@ Action* GenerateAction(const char* String)
 	action = GenerateActionCore( src, str, actionID);
 	if (!action) {
 		Log(ERROR, "GameScript", "Malformed scripting action: %s", String);
+	} else {
+		if (compiledActions.size() >= MAX_COMPILED_STRINGS) {
+			ClearCompiledStrings();
+		}
+		// the copy has no references yet, the cache holds the only one
+		Action *copy = ParamCopy(action);
+		copy->IncRef();
+		compiledActions[actionString] = copy;
 	}
 	done:
 	free(actionString);
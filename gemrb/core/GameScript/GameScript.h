@@ -140,20 +140,28 @@ struct targettype {
 	unsigned int distance;
 };
 
-typedef std::list<targettype> targetlist;
+typedef std::vector<targettype> targetlist;
 
+// the targets are kept in the order they were added in and only sorted by
+// distance once something asks for them in order, since plenty of them are
+// just counted or thrown away
 class GEM_EXPORT Targets {
 public:
-	Targets()
-	{
-	}
+	Targets();
+	~Targets();
 
-	~Targets()
-	{
-		Clear();
-	}
+	Targets(const Targets&) = delete;
+	Targets& operator=(const Targets&) = delete;
+
+	// these get created and destroyed all the time by script evaluation,
+	// so the released ones are kept around for reuse
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr);
 private:
-	targetlist objects;
+	void Sort() const;
+
+	mutable targetlist objects;
+	mutable bool sorted = true;
 public:
 	int Count() const;
 	void dump() const;
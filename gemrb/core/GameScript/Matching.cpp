@@ -107,15 +107,15 @@ static inline bool DoObjectChecks(const Map *map, const Scriptable *Sender, cons
 	if (Sender->Type == ST_ACTOR) {
 		const Actor *source = (const Actor *) Sender;
 
+		// visual range check
+		int visualrange = source->Modified[IE_VISUALRANGE];
+		if (dist > visualrange*visualrange) return false;
+
 		// Detect() ignores invisibility completely
 		if (!ignoreinvis && target->IsInvisibleTo(source)) {
 			return false;
 		}
 
-		// visual range check
-		int visualrange = source->Modified[IE_VISUALRANGE];
-		if (dist > visualrange*visualrange) return false;
-
 		// LOS check
 		if (!map->IsVisibleLOS(Sender->Pos, target->Pos)) return false;
 
@@ -137,6 +137,63 @@ static inline bool DoObjectChecks(const Map *map, const Scriptable *Sender, cons
 	return true;
 }
 
+// the IDS functions that depend on a single stat only, so the area index can answer them
+static const struct {
+	IDSFunction func;
+	unsigned int stat;
+} indexedIDS[] = {
+	{ GameScript::ID_Allegiance, IE_EA },
+	{ GameScript::ID_General, IE_GENERAL },
+	{ GameScript::ID_Race, IE_RACE },
+	{ GameScript::ID_Specific, IE_SPECIFIC },
+	{ GameScript::ID_Gender, IE_SEX },
+	{ GameScript::ID_Alignment, IE_ALIGNMENT }
+};
+
+/* narrows the actors down to the smallest set any of the indexed IDS fields allows,
+ * in area order; the full IDS check is still needed on them */
+static bool GetIndexedCandidates(const Map *map, const Object *oC, std::vector<Actor *> &candidates)
+{
+	const ActorStatIndex &index = map->GetActorStatIndex();
+	std::vector<Actor *> found;
+	bool indexed = false;
+	for (int j = 0; j < ObjectIDSCount; j++) {
+		int value = oC->objectFields[j];
+		if (!value || !idtargets[j]) {
+			continue;
+		}
+		IDSFunction func = idtargets[j];
+		for (const auto &ids : indexedIDS) {
+			if (ids.func != func) continue;
+
+			index.Query(ActorStatIndex::StatSlot(ids.stat), [func, value](const Actor *ac) {
+				return func(ac, value) != 0;
+			}, found);
+			if (!indexed || found.size() < candidates.size()) {
+				candidates.swap(found);
+				indexed = true;
+			}
+			break;
+		}
+		if (indexed && candidates.empty()) break;
+	}
+	return indexed;
+}
+
+/* the actors close enough to pass the visual range check of DoObjectChecks, in area order */
+static bool GetNearbyCandidates(const Map *map, const Scriptable *Sender, std::vector<Actor *> &candidates)
+{
+	if (Sender->Type != ST_ACTOR) {
+		return false;
+	}
+	// SquaredMapDistance compares 16x12 pixel cells, so one more cell of slack
+	int visualrange = std::max<int>(((const Actor *) Sender)->Modified[IE_VISUALRANGE], 0) + 1;
+	int w = visualrange * 16;
+	int h = visualrange * 12;
+	map->GetActorGrid().Query(Region(Sender->Pos.x - w, Sender->Pos.y - h, 2 * w, 2 * h), candidates);
+	return true;
+}
+
 /* returns actors that match the [x.y.z] expression */
 static Targets *EvaluateObject(const Map *map, const Scriptable *Sender, const Object *oC, int ga_flags)
 {
@@ -200,10 +257,14 @@ static Targets *EvaluateObject(const Map *map, const Scriptable *Sender, const O
 	Targets *tgts = NULL;
 
 	//we need to get a subset of actors from the large array
-	//if this gets slow, we will need some index tables
-	int i = map->GetActorCount(true);
+	std::vector<Actor *> candidates;
+	bool indexed = GetIndexedCandidates(map, oC, candidates);
+	if (!indexed) {
+		indexed = GetNearbyCandidates(map, Sender, candidates);
+	}
+	int i = indexed ? (int) candidates.size() : map->GetActorCount(true);
 	while (i--) {
-		Actor *ac = map->GetActor(i, true);
+		Actor *ac = indexed ? candidates[i] : map->GetActor(i, true);
 		if (!ac) continue; // is this check really needed?
 		// don't return Sender in IDS targeting!
 		// unless it's pst, which relies on it in 3012cut2-3012cut7.bcs
@@ -707,26 +768,25 @@ Targets *XthNearestEnemyOf(Targets *parameters, int count, int ga_flags)
 		return parameters;
 	}
 	const Map *map = origin->GetCurrentArea();
-	int i = map->GetActorCount(true);
+	// only look at the other side, before doing any of the costlier checks
+	std::vector<Actor *> enemies;
+	map->GetActorStatIndex().Query(ActorStatIndex::StatSlot(IE_EA), [type](const Actor *ac) {
+		if (type) { //origin is PC
+			return ac->GetStat(IE_EA) >= EA_EVILCUTOFF;
+		}
+		return ac->GetStat(IE_EA) <= EA_GOODCUTOFF;
+	}, enemies);
+	int i = (int) enemies.size();
 	ga_flags |= GA_NO_UNSCHEDULED|GA_NO_DEAD;
 	while (i--) {
-		Actor *ac = map->GetActor(i,true);
+		Actor *ac = enemies[i];
 		if (ac == origin) continue;
 		int distance;
 		//int distance = Distance(ac, origin);
 		// TODO: if it turns out you need to check Sender here, beware you take the right distance!
 		// (n the original games, this is only used for NearestEnemyOf(Player1) in obsgolem.bcs)
 		if (!DoObjectChecks(map, origin, ac, distance)) continue;
-		if (type) { //origin is PC
-			if (ac->GetStat(IE_EA) >= EA_EVILCUTOFF) {
-				parameters->AddTarget(ac, distance, ga_flags);
-			}
-		}
-		else {
-			if (ac->GetStat(IE_EA) <= EA_GOODCUTOFF) {
-				parameters->AddTarget(ac, distance, ga_flags);
-			}
-		}
+		parameters->AddTarget(ac, distance, ga_flags);
 	}
 	return XthNearestOf(parameters,count, ga_flags);
 }
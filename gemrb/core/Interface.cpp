@@ -78,7 +78,11 @@
 #include "Scriptable/Container.h"
 #include "System/FileStream.h"
 #include "System/FileFilters.h"
+#if defined(SUPPORTS_MEMSTREAM)
+#include "System/MappedFileMemoryStream.h"
+#endif
 #include "System/StringBuffer.h"
+#include "System/ThreadPool.h"
 
 #include <utility>
 #include <vector>
@@ -298,6 +302,7 @@ Interface::~Interface(void)
 	delete plugin_flags;
 
 	delete projserv;
+	delete workerPool;
 
 	delete displaymsg;
 	delete TooltipBG;
@@ -1021,6 +1026,19 @@ int Interface::LoadFonts()
 	return GEM_OK;
 }
 
+// the big modded tlks are read all over, so map them where we can
+static DataStream* OpenTLK(const char* path)
+{
+#if defined(SUPPORTS_MEMSTREAM)
+	auto mapped = new MappedFileMemoryStream{path};
+	if (mapped->isOk()) {
+		return mapped;
+	}
+	delete mapped;
+#endif
+	return FileStream::OpenFile(path);
+}
+
 int Interface::Init(InterfaceConfig* cfg)
 {
 	Log(MESSAGE, "Core", "GemRB core version v" VERSION_GEMRB " loading ...");
@@ -1044,6 +1062,7 @@ int Interface::Init(InterfaceConfig* cfg)
 	CONFIG_INT("EndianSwitch", DataStream::SetBigEndian);
 	CONFIG_INT("GCDebug", GameControl::DebugFlags = );
 	CONFIG_INT("Height", config.Height =);
+	CONFIG_INT("HierarchicalPathfinding", config.HierarchicalPathfinding =);
 	CONFIG_INT("KeepCache", config.KeepCache =);
 	CONFIG_INT("MaxPartySize", config.MaxPartySize =);
 	config.MaxPartySize = std::min(std::max(1, config.MaxPartySize), 10);
@@ -1056,6 +1075,12 @@ int Interface::Init(InterfaceConfig* cfg)
 	int touchInput = -1;
 	CONFIG_INT("TouchInput", touchInput =);
 	CONFIG_INT("Width", config.Width =);
+	CONFIG_INT("WorkerThreads", config.WorkerThreads =);
+	config.WorkerThreads = Clamp(config.WorkerThreads, 0, 16);
+	CONFIG_INT("SaveCompression", config.SaveCompression =);
+	config.SaveCompression = Clamp(config.SaveCompression, 0, 9);
+	CONFIG_INT("QuickSaveCompression", config.QuickSaveCompression =);
+	config.QuickSaveCompression = Clamp(config.QuickSaveCompression, 0, 9);
 	CONFIG_INT("UseSoftKeyboard", config.UseSoftKeyboard =);
 	CONFIG_INT("NumFingScroll", config.NumFingScroll =);
 	CONFIG_INT("NumFingKboard", config.NumFingKboard =);
@@ -1315,6 +1340,8 @@ int Interface::Init(InterfaceConfig* cfg)
 			Log(FATAL, "Core", "The cache path couldn't be registered, please check!");
 			return GEM_ERROR;
 		}
+		// files of the loaded save, unless the game already wrote them to the cache
+		gamedata->AddSource(Holder<ResourceSource>(new SaveGameSource(saveGameAREExtractor)));
 
 		size_t i;
 		for (i = 0; i < config.ModPath.size(); ++i)
@@ -1479,6 +1506,9 @@ int Interface::Init(InterfaceConfig* cfg)
 		Log(ERROR, "Core", "Cannot Load Encoding.");
 	}
 
+	Log(MESSAGE, "Core", "Starting %d worker threads...", config.WorkerThreads);
+	workerPool = new ThreadPool(config.WorkerThreads);
+
 	Log(MESSAGE, "Core", "Creating Projectile Server...");
 	projserv = new ProjectileServer();
 	if (!projserv->GetHighestProjectileNumber()) {
@@ -1494,7 +1524,7 @@ int Interface::Init(InterfaceConfig* cfg)
 	Log(MESSAGE, "Core", "Loading Dialog.tlk file...");
 	char strpath[_MAX_PATH];
 	PathJoin(strpath, config.GamePath, "dialog.tlk", nullptr);
-	FileStream* fs = FileStream::OpenFile(strpath);
+	DataStream* fs = OpenTLK(strpath);
 	if (!fs) {
 		Log(FATAL, "Core", "Cannot find Dialog.tlk.");
 		return GEM_ERROR;
@@ -1507,7 +1537,7 @@ int Interface::Init(InterfaceConfig* cfg)
 		Log(MESSAGE, "Core", "Loading DialogF.tlk file...");
 		char strpath[_MAX_PATH];
 		PathJoin(strpath, config.GamePath, "dialogf.tlk", nullptr);
-		FileStream* fs = FileStream::OpenFile(strpath);
+		DataStream* fs = OpenTLK(strpath);
 		if (!fs) {
 			Log(ERROR, "Core", "Cannot find DialogF.tlk. Let us know which translation you are using.");
 			Log(ERROR, "Core", "Falling back to main TLK file, so female text may be wrong!");
@@ -1782,6 +1812,11 @@ ProjectileServer* Interface::GetProjectileServer() const
 	return projserv;
 }
 
+ThreadPool* Interface::GetWorkerPool() const
+{
+	return workerPool;
+}
+
 Video* Interface::GetVideoDriver() const
 {
 	return video.get();
@@ -3158,7 +3193,7 @@ void Interface::LoadGame(SaveGame *sg, int ver_override)
 	wmp_str2 = NULL;
 
 	LoadProgress(20);
-	// Unpack SAV (archive) file to Cache dir
+	// Index SAV (archive) file, its entries are read on demand
 	if (sav_str) {
 		PluginHolder<ArchiveImporter> ai = MakePluginHolder<ArchiveImporter>(IE_SAV_CLASS_ID);
 		if (ai) {
@@ -3642,6 +3677,8 @@ void Interface::RemoveFromCache(const ResRef& resref, SClass_ID ClassID)
 
 	PathJoinExt(filename, config.CachePath, resref, TypeExt(ClassID));
 	unlink ( filename);
+	// or it would be served from the loaded save again
+	saveGameAREExtractor.dropEntry(resref, TypeExt(ClassID));
 }
 
 //this function checks if the path is eligible as a cache
@@ -4403,7 +4440,7 @@ static bool IsBlobSaveItem(const char *path) {
 	return areExt != nullptr && path + pathLength - 4 == areExt;
 }
 
-int Interface::CompressSave(const char *folder, bool overrideRunning)
+int Interface::CompressSave(const char *folder, bool overrideRunning, bool quick)
 {
 	FileStream str;
 
@@ -4416,7 +4453,7 @@ int Interface::CompressSave(const char *folder, bool overrideRunning)
 	ai->CreateArchive( &str);
 
 	tick_t startTime = GetTicks();
-	// If we override the savegame we are running to fetch AREs from, it has already dumped
+	// If we override the savegame we are running to fetch files from, it has already dumped
 	// itself as "ares.blb" into the cache folder. Otherwise, just copy directly.
 	if (!overrideRunning && saveGameAREExtractor.copyRetainedAREs(&str) == GEM_ERROR) {
 		Log(ERROR, "Interface", "Failed to copy ARE files into new save game.");
@@ -4425,6 +4462,7 @@ int Interface::CompressSave(const char *folder, bool overrideRunning)
 
 	dir.SetFlags(DirectoryIterator::Files);
 	//.tot and .toh should be saved last, because they are updated when an .are is saved
+	std::vector<std::string> paths;
 	int priority=2;
 	while(priority) {
 		do {
@@ -4432,18 +4470,19 @@ int Interface::CompressSave(const char *folder, bool overrideRunning)
 			if (SavedExtension(name)==priority) {
 				char dtmp[_MAX_PATH];
 				dir.GetFullPath(dtmp);
+
+				if (!IsBlobSaveItem(dtmp)) {
+					// packed all at once below
+					paths.push_back(dtmp);
+					continue;
+				}
+
 				FileStream fs;
 				if (!fs.Open(dtmp)) {
 					Log(ERROR, "Interface", "Failed to open \"%s\".", dtmp);
-				}
-
-				if (IsBlobSaveItem(dtmp)) {
-					if (overrideRunning) {
-						saveGameAREExtractor.updateSaveGame(str.GetPos());
-						ai->AddToSaveGameCompressed(&str, &fs);
-					}
-				} else {
-					ai->AddToSaveGame(&str, &fs);
+				} else if (overrideRunning) {
+					saveGameAREExtractor.updateSaveGame(str.GetPos());
+					ai->AddToSaveGameCompressed(&str, &fs);
 				}
 			}
 		} while (++dir);
@@ -4454,6 +4493,11 @@ int Interface::CompressSave(const char *folder, bool overrideRunning)
 		}
 	}
 
+	int level = quick ? config.QuickSaveCompression : config.SaveCompression;
+	if (ai->AddFilesToSaveGame(&str, paths, level) == GEM_ERROR) {
+		Log(ERROR, "Interface", "Failed to pack some files into the new save game.");
+	}
+
 	tick_t endTime = GetTicks();
 	Log(WARNING, "Core", "%lu ms (compressing SAV file)", endTime - startTime);
 	return GEM_OK;
@@ -75,6 +75,7 @@ class MusicMgr;
 class Palette;
 using PaletteHolder = Holder<Palette>;
 class ProjectileServer;
+class ThreadPool;
 class Resource;
 class SPLExtHeader;
 class SaveGame;
@@ -361,6 +362,10 @@ struct CFGConfigData {
 
 	bool KeepCache = false;
 	bool MultipleQuickSaves = false;
+	bool HierarchicalPathfinding = true;
+	int WorkerThreads = 2; // 0 keeps everything on the main thread
+	int SaveCompression = 9; // zlib level for saves made by the player
+	int QuickSaveCompression = 1; // zlib level for quick and auto saves
 	// once GemRB own format is working well, this might be set to 0
 	int SaveAsOriginal = 1; // if true, saves files in compatible mode
 	std::string VideoDriverName = "sdl"; // consider deprecating? It's now a hidden option
@@ -381,6 +386,7 @@ private:
 	Holder<Audio> AudioDriver;
 
 	ProjectileServer * projserv;
+	ThreadPool *workerPool = nullptr;
 
 	WindowManager* winmgr;
 	Holder<GUIFactory> guifact;
@@ -482,6 +488,8 @@ public:
 	bool IsAvailable(SClass_ID filetype) const;
 	const char * TypeExt(SClass_ID type) const;
 	ProjectileServer* GetProjectileServer() const;
+	/** Get the helper threads for parallel jobs */
+	ThreadPool* GetWorkerPool() const;
 	Video * GetVideoDriver() const;
 	/* create or change a custom string */
 	ieStrRef UpdateString(ieStrRef strref, const char *text) const;
@@ -703,7 +711,7 @@ public:
 	/** saves the worldmap object to the destination folder */
 	int WriteWorldMap(const char *folder);
 	/** saves the .are and .sto files to the destination folder */
-	int CompressSave(const char *folder, bool overrideRunning);
+	int CompressSave(const char *folder, bool overrideRunning, bool quick);
 	/** toggles the pause. returns either PAUSE_ON or PAUSE_OFF to reflect the script state after toggling. */
 	PauseSetting TogglePause() const;
 	/** returns true the passed pause setting was applied. false otherwise. */
@@ -53,6 +53,7 @@
 #include "Scriptable/Door.h"
 #include "Scriptable/InfoPoint.h"
 #include "System/StringBuffer.h"
+#include "System/ThreadPool.h"
 
 #include <cassert>
 #include <limits>
@@ -488,6 +489,10 @@ void Map::AddTileMap(TileMap* tm, Holder<Sprite2D> lm, Bitmap* sr, Holder<Sprite
 
 	//delete the original searchmap
 	delete sr;
+
+	pathHierarchy.Build(SrchMap, mapSize);
+	blockPlanes.Build(SrchMap, mapSize);
+	actorGrid.Resize(Size(mapSize.w * 16, mapSize.h * 12));
 }
 void Map::AutoLockDoors() const
 {
@@ -666,8 +671,71 @@ void Map::DrawPortal(const InfoPoint *ip, int enable)
 	}
 }
 
+void Map::RequestPath(Actor *actor)
+{
+	if (!core->GetWorkerPool()->ThreadCount()) {
+		// no helpers, so stay synchronous and deterministic
+		actor->NewPath();
+		return;
+	}
+	if (std::find(pathRequests.begin(), pathRequests.end(), actor) == pathRequests.end()) {
+		pathRequests.push_back(actor);
+	}
+}
+
+// The searches only read the area, so they can all run at once. The
+// requesters' own search map footprints are cleared beforehand, like
+// WalkTo does, and the results are applied in the order of the requests.
+void Map::ResolvePathRequests()
+{
+	if (pathRequests.empty()) return;
+
+	std::vector<Actor *> walkers;
+	for (Actor *actor : pathRequests) {
+		if (actor->BeginNewPath()) {
+			walkers.push_back(actor);
+		}
+	}
+	pathRequests.clear();
+	if (walkers.empty()) return;
+
+	ThreadPool *pool = core->GetWorkerPool();
+	requestWorkspaces.resize(pool->ThreadCount() + 1);
+	for (PathFinderWorkspace &ws : requestWorkspaces) {
+		ws.DeferLog(true);
+	}
+	// patch the cluster graph now, the searches may not modify it
+	pathHierarchy.Update();
+
+	std::vector<Path> newPaths(walkers.size());
+	std::vector<std::vector<PathFinderWorkspace::LogEntry>> logs(walkers.size());
+	pool->ParallelFor(walkers.size(), [&](size_t i, unsigned int thread) {
+		const Actor *actor = walkers[i];
+		PathFinderWorkspace &ws = requestWorkspaces[thread];
+		newPaths[i] = FindWalkPath(actor, actor->Destination, actor->GetPathfindingDistance(), ws);
+		logs[i] = ws.TakeLog();
+	});
+
+	for (size_t i = 0; i < walkers.size(); ++i) {
+		for (const auto &entry : logs[i]) {
+			Log(DEBUG, entry.first, "%s", entry.second.c_str());
+		}
+		walkers[i]->EndNewPath(std::move(newPaths[i]));
+	}
+}
+
 void Map::UpdateScripts()
 {
+	// LOS results are only kept for a single tick
+	losCache.clear();
+
+	// catch any position changes that bypassed ActorMoved
+	for (auto actor : actors) {
+		actorGrid.Update(actor);
+	}
+
+	ResolvePathRequests();
+
 	bool has_pcs = false;
 	for (auto actor : actors) {
 		if (actor->InParty) {
@@ -772,14 +840,14 @@ void Map::UpdateScripts()
 		if (actor->GetRandomBackoff()) {
 			actor->DecreaseBackoff();
 			if (!actor->GetRandomBackoff() && actor->GetSpeed() > 0) {
-				actor->NewPath();
+				RequestPath(actor);
 			}
 		} else if (actor->GetStep() && actor->GetSpeed()) {
 			// Make actors pathfind if there are others nearby
 			// in order to avoid bumping when possible
 			const Actor* nearActor = GetActorInRadius(actor->Pos, GA_NO_DEAD|GA_NO_UNSCHEDULED, actor->GetAnims()->GetCircleSize());
 			if (nearActor && nearActor != actor) {
-				actor->NewPath();
+				RequestPath(actor);
 			}
 			DoStepForActor(actor, time);
 		} else {
@@ -931,11 +999,55 @@ bool Map::FogTileUncovered(const Point &p, const uint8_t* mask) const
 	
 	if (mask == nullptr) return true;
 
-	div_t res = div(fogSize.w * p.y + p.x, 8);
-	return bool(mask[res.quot] & (1 << res.rem));
+	unsigned int bit = fogSize.w * p.y + p.x;
+	return bool(mask[bit / 8] & (1 << (bit % 8)));
+}
+
+bool Map::FogChanged(const ieByte* explored_mask, const ieByte* visible_mask, const Region& vp) const
+{
+	if (vp != fogViewport) return true;
+	if (bool(explored_mask) != fogExploredMasked || bool(visible_mask) != fogVisibleMasked) return true;
+
+	size_t size = GetExploredMapSize();
+	if (explored_mask && (fogExploredDrawn.size() != size || memcmp(explored_mask, fogExploredDrawn.data(), size))) {
+		return true;
+	}
+	if (visible_mask && (fogVisibleDrawn.size() != size || memcmp(visible_mask, fogVisibleDrawn.data(), size))) {
+		return true;
+	}
+	return false;
 }
 
 void Map::DrawFogOfWar(const ieByte* explored_mask, const ieByte* visible_mask, const Region& vp)
+{
+	Video* vid = core->GetVideoDriver();
+	if (!fogBuffer || fogBuffer->Size() != vp.size) {
+		fogBuffer = vid->CreateBuffer(Region(Point(), vp.size), Video::BufferFormat::DISPLAY_ALPHA);
+		fogViewport = Region();
+	}
+
+	if (FogChanged(explored_mask, visible_mask, vp)) {
+		// the view clip is applied when blitting, the buffer has to be complete
+		const Region clip = vid->GetScreenClip();
+		fogBuffer->Clear();
+		vid->PushDrawingBuffer(fogBuffer);
+		vid->SetScreenClip(nullptr);
+		RenderFogOfWar(explored_mask, visible_mask, vp);
+		vid->SetScreenClip(&clip);
+		vid->PopDrawingBuffer();
+
+		size_t size = GetExploredMapSize();
+		fogViewport = vp;
+		fogExploredMasked = explored_mask != nullptr;
+		fogVisibleMasked = visible_mask != nullptr;
+		if (explored_mask) fogExploredDrawn.assign(explored_mask, explored_mask + size);
+		if (visible_mask) fogVisibleDrawn.assign(visible_mask, visible_mask + size);
+	}
+
+	vid->BlitVideoBuffer(fogBuffer, Point(), BlitFlags::BLENDED);
+}
+
+void Map::RenderFogOfWar(const ieByte* explored_mask, const ieByte* visible_mask, const Region& vp) const
 {
 	// Size of Fog-Of-War shadow tile (and bitmap)
 	constexpr int CELL_SIZE = 32;
@@ -1868,20 +1980,16 @@ void Map::DrawSearchMap(const Region &vp) const
 	// draw also pathfinding waypoints
 	const Actor *act = core->GetFirstSelectedActor();
 	if (!act) return;
-	const PathNode *path = act->GetPath();
-	if (!path) return;
-	const PathNode *step = path->Next;
+	const Path &path = act->GetPath();
 	Color waypoint(0, 64, 128, 128); // darker blue-ish
-	int i = 0;
 	block.w = 8;
 	block.h = 6;
-	while (step) {
-		block.x = (step->x+64) - vp.x;
-		block.y = (step->y+6) - vp.y;
-		print("Waypoint %d at (%d, %d)", i, step->x, step->y);
+	for (size_t i = 1; i < path.size(); i++) {
+		const PathNode &step = path[i];
+		block.x = (step.x+64) - vp.x;
+		block.y = (step.y+6) - vp.y;
+		print("Waypoint %d at (%d, %d)", int(i - 1), step.x, step.y);
 		vid->DrawRect(block, waypoint);
-		step = step->Next;
-		i++;
 	}
 }
 
@@ -2034,6 +2142,8 @@ void Map::AddActor(Actor* actor, bool init)
 	actor->Area = ResRef::MakeLowerCase(scriptName);
 	if (!HasActor(actor)) {
 		actors.push_back( actor );
+		actorGrid.Insert(actor);
+		statIndex.Insert(actor);
 	}
 	if (init) {
 		actor->SetMap(this);
@@ -2079,6 +2189,10 @@ void Map::DeleteActor(int i)
 		}
 	}
 	//remove the actor from the area's actor list
+	actorGrid.Remove(actors[i]);
+	statIndex.Remove(actors[i]);
+	fogFootprints.erase(actors[i]);
+	pathRequests.erase(std::remove(pathRequests.begin(), pathRequests.end(), actors[i]), pathRequests.end());
 	actors.erase( actors.begin()+i );
 }
 
@@ -2169,9 +2283,23 @@ Actor* Map::GetActorByGlobalID(ieDword objectID) const
  GA_POINT     64  - not actor specific
  GA_NO_HIDDEN 128 - hidden actors don't play
 */
+void Map::ActorMoved(const Actor *actor)
+{
+	actorGrid.Update(actor);
+}
+
+void Map::ActorStatsChanged(const Actor *actor)
+{
+	statIndex.Update(actor);
+}
+
 Actor* Map::GetActor(const Point &p, int flags, const Movable *checker) const
 {
-	for (auto actor : actors) {
+	// IsOver checks an ellipse of at most this size
+	int reach = (std::max(actorGrid.MaxActorSize(), 2) - 1) * 16;
+	std::vector<Actor *> candidates;
+	actorGrid.Query(Region(p.x - reach, p.y - reach, 2 * reach, 2 * reach), candidates);
+	for (auto actor : candidates) {
 		if (!actor->IsOver( p ))
 			continue;
 		if (!actor->ValidTarget(flags, checker) ) {
@@ -2184,7 +2312,11 @@ Actor* Map::GetActor(const Point &p, int flags, const Movable *checker) const
 
 Actor* Map::GetActorInRadius(const Point &p, int flags, unsigned int radius) const
 {
-	for (auto actor : actors) {
+	// PersonalDistance discounts the actor size
+	int reach = radius + actorGrid.MaxActorSize() * 10;
+	std::vector<Actor *> candidates;
+	actorGrid.Query(Region(p.x - reach, p.y - reach, 2 * reach, 2 * reach), candidates);
+	for (auto actor : candidates) {
 		if (PersonalDistance( p, actor ) > radius)
 			continue;
 		if (!actor->ValidTarget(flags) ) {
@@ -2198,7 +2330,11 @@ Actor* Map::GetActorInRadius(const Point &p, int flags, unsigned int radius) con
 std::vector<Actor *> Map::GetAllActorsInRadius(const Point &p, int flags, unsigned int radius, const Scriptable *see) const
 {
 	std::vector<Actor *> neighbours;
-	for (auto actor : actors) {
+	// WithinRange stretches the radius by at most 16 pixels per foot
+	int reach = radius * 16 + 1;
+	std::vector<Actor *> candidates;
+	actorGrid.Query(Region(p.x - reach, p.y - reach, 2 * reach, 2 * reach), candidates);
+	for (auto actor : candidates) {
 		if (!WithinRange(actor, p, radius)) {
 			continue;
 		}
@@ -2321,6 +2457,7 @@ void Map::PurgeArea(bool items)
 		if (!actor->ValidTarget(GA_NO_DEAD|GA_NO_UNSCHEDULED|GA_NO_ALLY|GA_NO_ENEMY)) continue;
 		if (!actor->HomeLocation.IsZero() && !actor->HomeLocation.IsInvalid() && actor->Pos != actor->HomeLocation) {
 			actor->Pos = actor->HomeLocation;
+			actorGrid.Update(actor);
 		}
 	}
 }
@@ -2440,9 +2577,13 @@ Actor *Map::GetActorByScriptName(const char *name) const
 
 int Map::GetActorsInRect(Actor**& actorlist, const Region& rgn, int excludeFlags) const
 {
-	actorlist = ( Actor * * ) malloc( actors.size() * sizeof( Actor * ) );
+	// also include anyone whose circle covers the origin
+	int reach = (std::max(actorGrid.MaxActorSize(), 2) - 1) * 16;
+	std::vector<Actor *> candidates;
+	actorGrid.Query(Region(rgn.x - reach, rgn.y - reach, rgn.w + 2 * reach, rgn.h + 2 * reach), candidates);
+	actorlist = ( Actor * * ) malloc( candidates.size() * sizeof( Actor * ) );
 	int count = 0;
-	for (auto actor : actors) {
+	for (auto actor : candidates) {
 		if (!actor->ValidTarget(excludeFlags))
 			continue;
 		if (!rgn.PointInside(actor->Pos)
@@ -2542,21 +2683,24 @@ PathMapFlags Map::GetBlockedInRadius(const Point &p, unsigned int size, bool sto
 	if (size < 2) size = 2;
 	PathMapFlags ret = PathMapFlags::IMPASSABLE;
 
-	unsigned int r = (size - 2) * (size - 2) + 1;
-	if (size == 2) r = 0;
-	for (unsigned int i = 0; i < size - 1; i++) {
-		for (unsigned int j = 0; j < size - 1; j++) {
-			if (i * i + j * j <= r) {
-				PathMapFlags retBotRight = GetBlockedNavmap(Point(p.x + i * 16, p.y + j * 12));
-				PathMapFlags retTopRight = GetBlockedNavmap(Point(p.x + i * 16, p.y - j * 12));
-				PathMapFlags retBotLeft = GetBlockedNavmap(Point(p.x - i * 16, p.y + j * 12));
-				PathMapFlags retTopLeft = GetBlockedNavmap(Point(p.x - i * 16, p.y - j * 12));
-				if (stopOnImpassable) {
-					if (retBotRight == PathMapFlags::IMPASSABLE || retBotLeft == PathMapFlags::IMPASSABLE || retTopRight == PathMapFlags::IMPASSABLE || retTopLeft == PathMapFlags::IMPASSABLE) {
-						return PathMapFlags::IMPASSABLE;
-					}
+	unsigned int radius = size - 2;
+	SearchmapPoint center = ConvertCoordToTile(p);
+	if (blockPlanes.Covers(center, radius)) {
+		bool anyImpassable;
+		ret = blockPlanes.QueryCircle(center, radius, anyImpassable);
+		if (stopOnImpassable && anyImpassable) {
+			return PathMapFlags::IMPASSABLE;
+		}
+	} else {
+		// near the map edges, where some samples fall outside of it
+		for (int dy = -int(radius); dy <= int(radius); dy++) {
+			int span = SearchmapPlanes::CircleSpan(radius, dy);
+			for (int dx = -span; dx <= span; dx++) {
+				PathMapFlags blockStatus = GetBlockedNavmap(Point(p.x + dx * 16, p.y + dy * 12));
+				if (stopOnImpassable && blockStatus == PathMapFlags::IMPASSABLE) {
+					return PathMapFlags::IMPASSABLE;
 				}
-				ret |= (retBotRight | retTopRight | retBotLeft | retTopLeft);
+				ret |= blockStatus;
 			}
 		}
 	}
@@ -2570,22 +2714,54 @@ PathMapFlags Map::GetBlockedInRadius(const Point &p, unsigned int size, bool sto
 	return ret;
 }
 
-PathMapFlags Map::GetBlockedInLine(const Point &s, const Point &d, bool stopOnImpassable, const Actor *caller) const
+// Walks the searchmap cells crossed by the segment from s to d (navmap coordinates)
+// with an integer DDA, so every cell the line touches is checked exactly once
+PathMapFlags Map::GetBlockedInLine(const Point &s, const Point &d, bool stopOnImpassable) const
 {
 	PathMapFlags ret = PathMapFlags::IMPASSABLE;
-	Point p = s;
-	while (p != d) {
-		double dx = d.x - p.x;
-		double dy = d.y - p.y;
-		double factor = caller && caller->GetSpeed() ? double(gamedata->GetStepTime()) / double(caller->GetSpeed()) : 1;
-		NormalizeDeltas(dx, dy, factor);
-		p.x += dx;
-		p.y += dy;
-		PathMapFlags blockStatus = GetBlockedNavmap(p);
+	if (s == d) return ret;
+
+	SearchmapPoint cell = ConvertCoordToTile(s);
+	SearchmapPoint end = ConvertCoordToTile(d);
+	int adx = std::abs(d.x - s.x);
+	int ady = std::abs(d.y - s.y);
+	int stepX = d.x > s.x ? 1 : -1;
+	int stepY = d.y > s.y ? 1 : -1;
+	// doubled distances from the pixel centre of s to the next cell edges,
+	// scaled by the other axis' delta so they can be compared without division
+	long long nextX = stepX > 0 ? (cell.x + 1) * 32 - (2 * s.x + 1) : (2 * s.x + 1) - cell.x * 32;
+	long long nextY = stepY > 0 ? (cell.y + 1) * 24 - (2 * s.y + 1) : (2 * s.y + 1) - cell.y * 24;
+	nextX *= ady;
+	nextY *= adx;
+	int steps = std::abs(end.x - cell.x) + std::abs(end.y - cell.y);
+
+	while (true) {
+		PathMapFlags blockStatus = GetBlocked(cell);
 		if (stopOnImpassable && blockStatus == PathMapFlags::IMPASSABLE) {
 			return PathMapFlags::IMPASSABLE;
 		}
 		ret |= blockStatus;
+		if (steps-- <= 0) break;
+
+		if (ady == 0 || (adx != 0 && nextX < nextY)) {
+			cell.x += stepX;
+			nextX += 32LL * ady;
+		} else if (adx == 0 || nextY < nextX) {
+			cell.y += stepY;
+			nextY += 24LL * adx;
+		} else {
+			// exactly through a corner, don't let it slip between two diagonal cells
+			cell.x += stepX;
+			nextX += 32LL * ady;
+			blockStatus = GetBlocked(cell);
+			if (stopOnImpassable && blockStatus == PathMapFlags::IMPASSABLE) {
+				return PathMapFlags::IMPASSABLE;
+			}
+			ret |= blockStatus;
+			cell.y += stepY;
+			nextY += 24LL * adx;
+			steps--;
+		}
 	}
 	if (bool(ret & (PathMapFlags::DOOR_IMPASSABLE|PathMapFlags::ACTOR|PathMapFlags::SIDEWALL))) {
 		ret &= ~PathMapFlags::PASSABLE;
@@ -2598,16 +2774,34 @@ PathMapFlags Map::GetBlockedInLine(const Point &s, const Point &d, bool stopOnIm
 }
 
 // PathMapFlags::SIDEWALL obstructs LOS, while PathMapFlags::IMPASSABLE doesn't
-bool Map::IsVisibleLOS(const Point &s, const Point &d, const Actor *caller) const
+// LOS only depends on walls and doors, so the results are memoised until the
+// next script tick or until a door changes the searchmap
+bool Map::IsVisibleLOS(const Point &s, const Point &d) const
 {
-	PathMapFlags ret = GetBlockedInLine(s, d, false, caller);
-	return !bool(ret & PathMapFlags::SIDEWALL);
+	bool cacheable = s.x >= 0 && s.y >= 0 && d.x >= 0 && d.y >= 0 && s.x <= 0xffff && s.y <= 0xffff && d.x <= 0xffff && d.y <= 0xffff;
+	uint64_t key = (uint64_t(s.x) << 48) | (uint64_t(s.y) << 32) | (uint64_t(d.x) << 16) | uint64_t(d.y);
+	// the pathfinder may be calling this from several threads
+	if (cacheable) {
+		std::lock_guard<std::mutex> l(losCacheLock);
+		auto cached = losCache.find(key);
+		if (cached != losCache.end()) {
+			return cached->second;
+		}
+	}
+
+	PathMapFlags ret = GetBlockedInLine(s, d, false);
+	bool visible = !bool(ret & PathMapFlags::SIDEWALL);
+	if (cacheable) {
+		std::lock_guard<std::mutex> l(losCacheLock);
+		losCache[key] = visible;
+	}
+	return visible;
 }
 
 // Used by the pathfinder, so PathMapFlags::IMPASSABLE obstructs walkability
-bool Map::IsWalkableTo(const Point &s, const Point &d, bool actorsAreBlocking, const Actor *caller) const
+bool Map::IsWalkableTo(const Point &s, const Point &d, bool actorsAreBlocking) const
 {
-	PathMapFlags ret = GetBlockedInLine(s, d, true, caller);
+	PathMapFlags ret = GetBlockedInLine(s, d, true);
 	PathMapFlags mask = PathMapFlags::PASSABLE | PathMapFlags::TRAVEL | (actorsAreBlocking ? PathMapFlags::UNMARKED : PathMapFlags::ACTOR);
 	return bool(ret & mask);
 }
@@ -2914,6 +3108,10 @@ void Map::RemoveActor(Actor* actor)
 			ClearSearchMapFor(actor);
 			actor->SetMap(NULL);
 			actor->Area.Reset();
+			actorGrid.Remove(actor);
+			statIndex.Remove(actor);
+			fogFootprints.erase(actor);
+			pathRequests.erase(std::remove(pathRequests.begin(), pathRequests.end(), actor), pathRequests.end());
 			actors.erase( actors.begin()+i );
 			return;
 		}
@@ -3368,22 +3566,16 @@ void Map::FillExplored(bool explored) const
 	std::fill(ExploredBitmap, ExploredBitmap + GetExploredMapSize(), explored ? 0xff : 0x00);
 }
 
-void Map::ExploreTile(const Point &p)
-{
-	Point fogP = ConvertPointToFog(p);
+const int Map::FogFootprint::COLUMNS;
+const int Map::FogFootprint::ROWS;
 
+void Map::TraceFogFootprint(const Point &Pos, int range, int los, FogFootprint &footprint) const
+{
+	// the rays reach at most half a footprint away in either direction
+	footprint.origin = ConvertPointToFog(Pos) - Point(FogFootprint::COLUMNS / 2, FogFootprint::ROWS / 2);
+	std::fill(footprint.rows, footprint.rows + FogFootprint::ROWS, 0);
 	const Size fogSize = FogMapSize();
-	if (fogP.x < 0 || fogP.x >= fogSize.w || fogP.y < 0 || fogP.y >= fogSize.h) {
-		return;
-	}
-	
-	div_t res = div(fogSize.w * fogP.y + fogP.x, 8);
-	ExploredBitmap[res.quot] |= (1 << res.rem);
-	VisibleBitmap[res.quot] |= (1 << res.rem);
-}
 
-void Map::ExploreMapChunk(const Point &Pos, int range, int los)
-{
 	Point Tile;
 
 	if (range>MaxVisibility) {
@@ -3415,11 +3607,57 @@ void Map::ExploreMapChunk(const Point &Pos, int range, int los)
 					if (!Pass) break;
 				}
 			}
-			ExploreTile(Tile);
+
+			Point fogP = ConvertPointToFog(Tile);
+			if (fogP.x < 0 || fogP.x >= fogSize.w || fogP.y < 0 || fogP.y >= fogSize.h) {
+				continue;
+			}
+			Point cell = fogP - footprint.origin;
+			if (cell.x < 0 || cell.x >= FogFootprint::COLUMNS || cell.y < 0 || cell.y >= FogFootprint::ROWS) {
+				continue;
+			}
+			footprint.rows[cell.y] |= uint64_t(1) << cell.x;
+		}
+	}
+}
+
+// ORs a whole footprint row into the bitmap at once; only cells on the map
+// are ever set, so nothing spills into the neighbouring rows
+void Map::ApplyFogFootprint(const FogFootprint &footprint, ieByte *bitmap) const
+{
+	const Size fogSize = FogMapSize();
+	const size_t bitmapSize = GetExploredMapSize();
+	for (int row = 0; row < FogFootprint::ROWS; ++row) {
+		uint64_t bits = footprint.rows[row];
+		if (!bits) continue;
+
+		int x = footprint.origin.x;
+		if (x <= -FogFootprint::COLUMNS) break;
+		if (x < 0) {
+			bits >>= -x;
+			x = 0;
+		}
+		size_t bit = size_t(fogSize.w) * (footprint.origin.y + row) + x;
+		size_t byte = bit / 8;
+		int shift = bit % 8;
+		uint64_t low = bits << shift;
+		for (int k = 0; k < 8 && byte + k < bitmapSize; ++k) {
+			bitmap[byte + k] |= uint8_t(low >> (8 * k));
+		}
+		if (shift && byte + 8 < bitmapSize) {
+			bitmap[byte + 8] |= uint8_t(bits >> (64 - shift));
 		}
 	}
 }
 
+void Map::ExploreMapChunk(const Point &Pos, int range, int los)
+{
+	FogFootprint footprint;
+	TraceFogFootprint(Pos, range, los, footprint);
+	ApplyFogFootprint(footprint, ExploredBitmap);
+	ApplyFogFootprint(footprint, VisibleBitmap);
+}
+
 void Map::UpdateFog()
 {
 	std::fill(VisibleBitmap, VisibleBitmap + GetExploredMapSize(), 0);
@@ -3432,7 +3670,17 @@ void Map::UpdateFog()
 		
 		int vis2 = actor->Modified[IE_VISUALRANGE];
 		if ((state&STATE_BLIND) || (vis2<2)) vis2=2; //can see only themselves
-		ExploreMapChunk (actor->Pos, vis2+actor->GetAnims()->GetCircleSize(), 1);
+		int range = std::min(vis2 + actor->GetAnims()->GetCircleSize(), MaxVisibility);
+
+		FogFootprint &footprint = fogFootprints[actor];
+		if (footprint.pos != actor->Pos || footprint.range != range || footprint.wallsVersion != wallsVersion) {
+			TraceFogFootprint(actor->Pos, range, 1, footprint);
+			footprint.pos = actor->Pos;
+			footprint.range = range;
+			footprint.wallsVersion = wallsVersion;
+		}
+		ApplyFogFootprint(footprint, ExploredBitmap);
+		ApplyFogFootprint(footprint, VisibleBitmap);
 		
 		Spawn *sp = GetSpawnRadius(actor->Pos, SPAWN_RANGE); //30 * 12
 		if (sp) {
@@ -3454,33 +3702,18 @@ void Map::BlockSearchMap(const Point &Pos, unsigned int size, PathMapFlags value
 
 	if (size > MAX_CIRCLESIZE) size = MAX_CIRCLESIZE;
 	if (size < 1) size = 1;
-	int ppx = Pos.x/16;
-	int ppy = Pos.y/12;
-	unsigned int r=(size-1)*(size-1)+1;
-	for (unsigned int i=0; i<size; i++) {
-		for (unsigned int j=0; j<size; j++) {
-			if (i*i+j*j <= r) {
-				unsigned int ppxpi = ppx+i;
-				unsigned int ppypj = ppy+j;
-				unsigned int ppxmi = ppx-i;
-				unsigned int ppymj = ppy-j;
-				unsigned int pos = ppypj * mapSize.w + ppxpi;
-				if (ppxpi < (unsigned)mapSize.w && ppypj < (unsigned)mapSize.h && SrchMap[pos] != PathMapFlags::IMPASSABLE) {
-					SrchMap[pos] = (SrchMap[pos] & PathMapFlags::NOTACTOR) | value;
-				}
-				pos = ppymj * mapSize.w + ppxpi;
-				if (ppxpi < (unsigned)mapSize.w && ppymj < (unsigned)mapSize.h && SrchMap[pos] != PathMapFlags::IMPASSABLE) {
-					SrchMap[pos] = (SrchMap[pos] & PathMapFlags::NOTACTOR) | value;
-				}
-				pos = ppypj * mapSize.w + ppxmi;
-				if (ppxmi < (unsigned)mapSize.w && ppypj < (unsigned)mapSize.h && SrchMap[pos] != PathMapFlags::IMPASSABLE) {
-					SrchMap[pos] = (SrchMap[pos] & PathMapFlags::NOTACTOR) | value;
-				}
-				pos = ppymj * mapSize.w + ppxmi;
-				if (ppxmi < (unsigned)mapSize.w && ppymj < (unsigned)mapSize.h && SrchMap[pos] != PathMapFlags::IMPASSABLE) {
-					SrchMap[pos] = (SrchMap[pos] & PathMapFlags::NOTACTOR) | value;
-				}
-			}
+	int radius = size - 1;
+	SearchmapPoint center = ConvertCoordToTile(Pos);
+	for (int dy = -radius; dy <= radius; dy++) {
+		int y = center.y + dy;
+		if (y < 0 || y >= mapSize.h) continue;
+		int span = SearchmapPlanes::CircleSpan(radius, dy);
+		int xEnd = std::min(center.x + span, mapSize.w - 1);
+		for (int x = std::max(center.x - span, 0); x <= xEnd; x++) {
+			PathMapFlags &cell = SrchMap[y * mapSize.w + x];
+			if (cell == PathMapFlags::IMPASSABLE) continue;
+			cell = (cell & PathMapFlags::NOTACTOR) | value;
+			blockPlanes.Update(SearchmapPoint(x, y), cell);
 		}
 	}
 }
@@ -4090,7 +4323,14 @@ void Map::SetInternalSearchMap(int x, int y, PathMapFlags value)
 	if (x >= mapSize.w || y >= mapSize.h) {
 		return;
 	}
-	SrchMap[x + y * mapSize.w] = value;
+	PathMapFlags &cell = SrchMap[x + y * mapSize.w];
+	if (bool((cell ^ value) & PathMapFlags::NOTACTOR)) {
+		pathHierarchy.Invalidate(SearchmapPoint(x, y));
+		losCache.clear();
+		wallsVersion++;
+	}
+	cell = value;
+	blockPlanes.Update(SearchmapPoint(x, y), cell);
 }
 
 void Map::SetBackground(const ResRef &bgResRef, ieDword duration)
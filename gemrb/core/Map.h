@@ -24,16 +24,19 @@
 #include "exports.h"
 #include "globals.h"
 
+#include "ActorGrid.h"
+#include "ActorStatIndex.h"
 #include "Interface.h"
 #include "Scriptable/Scriptable.h"
 #include "PathFinder.h"
+#include "PathHierarchy.h"
+#include "SearchmapPlanes.h"
 
 #include <algorithm>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 
-template <class V> class FibonacciHeap;
-
 namespace GemRB {
 
 class Actor;
@@ -48,7 +51,6 @@ class MapReverb;
 class Palette;
 using PaletteHolder = Holder<Palette>;
 class Particles;
-struct PathNode;
 class Projectile;
 class ScriptedAnimation;
 class SpriteCover;
@@ -399,6 +401,8 @@ private:
 	Size mapSize;
 	std::list< AreaAnimation*> animations;
 	std::vector< Actor*> actors;
+	ActorGrid actorGrid;
+	ActorStatIndex statIndex;
 	std::vector<WallPolygonGroup> wallGroups;
 	std::list< VEFObject*> vvcCells;
 	std::list< Projectile*> projectiles;
@@ -415,8 +419,42 @@ private:
 	VideoBufferPtr wallStencil;
 	Region stencilViewport;
 
+	// the fog is drawn once into this and only redrawn when the view or the bits change
+	VideoBufferPtr fogBuffer;
+	Region fogViewport;
+	std::vector<ieByte> fogExploredDrawn;
+	std::vector<ieByte> fogVisibleDrawn;
+	bool fogExploredMasked = false;
+	bool fogVisibleMasked = false;
+
 	std::unordered_map<const void*, std::pair<VideoBufferPtr, Region>> objectStencils;
 
+	mutable PathFinderWorkspace pathWorkspace;
+	mutable PathHierarchy pathHierarchy;
+	// actors waiting for a new path and a search workspace for every worker thread
+	std::vector<Actor *> pathRequests;
+	std::vector<PathFinderWorkspace> requestWorkspaces;
+	SearchmapPlanes blockPlanes;
+	// navmap point pair -> visibility, see IsVisibleLOS
+	mutable std::unordered_map<uint64_t, bool> losCache;
+	mutable std::mutex losCacheLock;
+
+	// the fog cells seen from a spot, packed in rows around it; reused by
+	// UpdateFog until the explorer moves, its range changes or a door does
+	struct FogFootprint {
+		static const int COLUMNS = 64;
+		static const int ROWS = 32;
+
+		Point pos;
+		int range = -1;
+		unsigned long wallsVersion = 0;
+		Point origin; // fog cell of the first bit of the first row
+		uint64_t rows[ROWS];
+	};
+	std::unordered_map<const Actor *, FogFootprint> fogFootprints;
+	// bumped whenever the sight blocking part of the searchmap changes
+	unsigned long wallsVersion = 0;
+
 public:
 	Map(void);
 	~Map(void) override;
@@ -472,6 +510,12 @@ public:
 	void InitActors();
 	void InitActor(const Actor *actor);
 	void AddActor(Actor* actor, bool init);
+	/* keeps the actor lookup grid in sync, call after changing the position */
+	void ActorMoved(const Actor *actor);
+	const ActorGrid& GetActorGrid() const { return actorGrid; }
+	/* keeps the IDS matching index in sync, call after changing EA, RACE, ... */
+	void ActorStatsChanged(const Actor *actor);
+	const ActorStatIndex& GetActorStatIndex() const { return statIndex; }
 	//counts the summons already in the area
 	int CountSummons(ieDword flag, ieDword sex) const;
 	//returns true if an enemy is near P (used in resting/saving)
@@ -554,8 +598,6 @@ public:
 	Size GetSize() const;
 	int GetExploredMapSize() const;
 	void FillExplored(bool explored) const;
-	/* set one fog tile as visible. x, y are tile coordinates */
-	void ExploreTile(const Point&);
 	/* explore map from given point in map coordinates */
 	void ExploreMapChunk(const Point &Pos, int range, int los);
 	/* block or unblock searchmap with value */
@@ -568,24 +610,29 @@ public:
 	void AdjustPosition(Point &goal, int radiusx = 0, int radiusy = 0, int size = -1) const;
 	void AdjustPositionNavmap(Point &goal, int radiusx = 0, int radiusy = 0) const;
 	/* Finds the path which leads the farthest from d */
-	PathNode* RunAway(const Point &s, const Point &d, unsigned int size, int maxPathLength, bool backAway, const Actor *caller) const;
-	PathNode* RandomWalk(const Point &s, int size, int radius, const Actor *caller) const;
+	Path RunAway(const Point &s, const Point &d, unsigned int size, int maxPathLength, bool backAway, const Actor *caller) const;
+	Path RandomWalk(const Point &s, int size, int radius, const Actor *caller) const;
 	/* Returns true if there is no path to d */
 	bool TargetUnreachable(const Point &s, const Point &d, unsigned int size, bool actorsAreBlocking = false) const;
 	/* returns true if there is enemy visible */
 	bool AnyPCSeesEnemy() const;
 	/* Finds straight path from s, length l and orientation o, f=1 passes wall, f=2 rebounds from wall*/
-	PathNode* GetLine(const Point &start, const Point &dest, int flags) const;
-	PathNode* GetLine(const Point &start, int steps, unsigned int orient) const;
-	PathNode* GetLine(const Point &start, int Steps, int Orientation, int flags) const;
-	PathNode* GetLine(const Point &start, const Point &dest, int speed, int Orientation, int flags) const;
+	Path GetLine(const Point &start, const Point &dest, int flags) const;
+	Path GetLine(const Point &start, int steps, unsigned int orient) const;
+	Path GetLine(const Point &start, int Steps, int Orientation, int flags) const;
+	Path GetLine(const Point &start, const Point &dest, int speed, int Orientation, int flags) const;
 	/* Finds the path which leads to near d */
-	PathNode* FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance = 0, int flags = PF_SIGHT, const Actor *caller = NULL) const;
+	Path FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance = 0, int flags = PF_SIGHT, const Actor *caller = NULL) const;
+	/* The search of Movable::WalkTo, with a retry ignoring bumpable actors */
+	Path FindWalkPath(const Movable *walker, const Point &d, int minDistance) const;
+	/* Queues a repath of the actor towards its destination, which is done
+	 * on the worker threads at the start of the next script update */
+	void RequestPath(Actor *actor);
 
 	bool IsVisible(const Point &p) const;
 	bool IsExplored(const Point &p) const;
-	bool IsVisibleLOS(const Point &s, const Point &d, const Actor *caller = NULL) const;
-	bool IsWalkableTo(const Point &s, const Point &d, bool actorsAreBlocking, const Actor *caller) const;
+	bool IsVisibleLOS(const Point &s, const Point &d) const;
+	bool IsWalkableTo(const Point &s, const Point &d, bool actorsAreBlocking) const;
 
 	/* returns edge direction of map boundary, only worldmap regions */
 	int WhichEdge(const Point &s) const;
@@ -658,9 +705,13 @@ private:
 	void DrawPortal(const InfoPoint *ip, int enable);
 	void DrawHighlightables(const Region& viewport) const;
 	void DrawFogOfWar(const ieByte* explored_mask, const ieByte* visible_mask, const Region& viewport);
+	void RenderFogOfWar(const ieByte* explored_mask, const ieByte* visible_mask, const Region& viewport) const;
+	bool FogChanged(const ieByte* explored_mask, const ieByte* visible_mask, const Region& viewport) const;
 	Size FogMapSize() const;
 	bool FogTileUncovered(const Point &p, const uint8_t*) const;
 	Point ConvertPointToFog(const Point &p) const;
+	void TraceFogFootprint(const Point &pos, int range, int los, FogFootprint &footprint) const;
+	void ApplyFogFootprint(const FogFootprint &footprint, ieByte *bitmap) const;
 	
 	void GenerateQueues();
 	void SortQueues() const;
@@ -673,7 +724,12 @@ private:
 	bool AdjustPositionY(Point &goal, int radiusx, int radiusy, int size = -1) const;
 	
 	void UpdateSpawns() const;
-	PathMapFlags GetBlockedInLine(const Point &s, const Point &d, bool stopOnImpassable, const Actor *caller = NULL) const;
+	Path FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller, PathFinderWorkspace &ws) const;
+	bool FindPathDirect(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller, PathFinderWorkspace &ws, Path *path) const;
+	Path FindPathHierarchical(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller, PathFinderWorkspace &ws) const;
+	Path FindWalkPath(const Movable *walker, const Point &d, int minDistance, PathFinderWorkspace &ws) const;
+	void ResolvePathRequests();
+	PathMapFlags GetBlockedInLine(const Point &s, const Point &d, bool stopOnImpassable) const;
 
 };
 
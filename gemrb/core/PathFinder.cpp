@@ -34,15 +34,18 @@
 // Moving to each node in the path thus becomes an automatic regulation problem
 // which is solved with a P regulator, see Scriptable.cpp
 
-#include "FibonacciHeap.h"
 #include "GameData.h"
+#include "Interface.h"
 #include "Map.h"
 #include "PathFinder.h"
 #include "RNG.h"
 #include "Scriptable/Actor.h"
 
+#include <algorithm>
 #include <array>
-#include <limits>
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
 
 namespace GemRB {
 
@@ -58,9 +61,9 @@ constexpr std::array<double, RAND_DEGREES_OF_FREEDOM> dxRand{{0.000, -0.383, -0.
 constexpr std::array<double, RAND_DEGREES_OF_FREEDOM> dyRand{{1.000, 0.924, 0.707, 0.383, 0.000, -0.383, -0.707, -0.924, -1.000, -0.924, -0.707, -0.383, 0.000, 0.383, 0.707, 0.924}};
 
 // Find the best path of limited length that brings us the farthest from d
-PathNode *Map::RunAway(const Point &s, const Point &d, unsigned int size, int maxPathLength, bool backAway, const Actor *caller) const
+Path Map::RunAway(const Point &s, const Point &d, unsigned int size, int maxPathLength, bool backAway, const Actor *caller) const
 {
-	if (!caller || !caller->GetSpeed()) return nullptr;
+	if (!caller || !caller->GetSpeed()) return Path();
 	Point p = s;
 	double dx = s.x - d.x;
 	double dy = s.y - d.y;
@@ -86,9 +89,9 @@ PathNode *Map::RunAway(const Point &s, const Point &d, unsigned int size, int ma
 	return FindPath(s, p, size, size, flags, caller);
 }
 
-PathNode *Map::RandomWalk(const Point &s, int size, int radius, const Actor *caller) const
+Path Map::RandomWalk(const Point &s, int size, int radius, const Actor *caller) const
 {
-	if (!caller || !caller->GetSpeed()) return nullptr;
+	if (!caller || !caller->GetSpeed()) return Path();
 	NavmapPoint p = s;
 	size_t i = RAND<size_t>(0, RAND_DEGREES_OF_FREEDOM - 1);
 	double dx = 3 * dxRand[i];
@@ -101,7 +104,7 @@ PathNode *Map::RandomWalk(const Point &s, int size, int radius, const Actor *cal
 			tries++;
 			// Give up if backed into a corner
 			if (tries > RAND_DEGREES_OF_FREEDOM) {
-				return nullptr;
+				return Path();
 			}
 			// Random rotation
 			i = RAND<size_t>(0, RAND_DEGREES_OF_FREEDOM - 1);
@@ -118,42 +121,29 @@ PathNode *Map::RandomWalk(const Point &s, int size, int radius, const Actor *cal
 		p.x -= dx;
 		p.y -= dy;
 	}
-	PathNode *step = new PathNode;
-	step->x = p.x;
-	step->y = p.y;
-	step->x = Clamp<unsigned int>(step->x, 1u, (mapSize.w - 1) * 16);
-	step->y = Clamp<unsigned int>(step->y, 1u, (mapSize.h - 1) * 12);
-	step->Parent = nullptr;
-	step->Next = nullptr;
-	step->orient = GetOrient(p, s);
-	return step;
+	PathNode step;
+	step.x = Clamp<unsigned int>(p.x, 1u, (mapSize.w - 1) * 16);
+	step.y = Clamp<unsigned int>(p.y, 1u, (mapSize.h - 1) * 12);
+	step.orient = GetOrient(p, s);
+	return Path(1, step);
 }
 
 bool Map::TargetUnreachable(const Point &s, const Point &d, unsigned int size, bool actorsAreBlocking) const
 {
 	int flags = PF_SIGHT;
 	if (actorsAreBlocking) flags |= PF_ACTORS_ARE_BLOCKING;
-	PathNode *path = FindPath(s, d, size, 0, flags);
-	bool targetUnreachable = path == nullptr;
-	if (!targetUnreachable) {
-		PathNode *thisNode = path;
-		while (thisNode) {
-			PathNode *nextNode = thisNode->Next;
-			delete(thisNode);
-			thisNode = nextNode;
-		}
-	}
-	return targetUnreachable;
+	// only the outcome matters, so skip the cluster graph and don't build the path
+	return !FindPathDirect(s, d, size, 0, flags, nullptr, pathWorkspace, nullptr);
 }
 
 // Use this function when you target something by a straight line projectile (like a lightning bolt, arrow, etc)
-PathNode *Map::GetLine(const Point &start, const Point &dest, int flags) const
+Path Map::GetLine(const Point &start, const Point &dest, int flags) const
 {
 	int Orientation = GetOrient(start, dest);
 	return GetLine(start, dest, 1, Orientation, flags);
 }
 
-PathNode *Map::GetLine(const Point &start, int Steps, int Orientation, int flags) const
+Path Map::GetLine(const Point &start, int Steps, int Orientation, int flags) const
 {
 	Point dest = start;
 
@@ -180,18 +170,14 @@ PathNode *Map::GetLine(const Point &start, int Steps, int Orientation, int flags
 	return GetLine(start, dest, 2, Orientation, flags);
 }
 
-PathNode *Map::GetLine(const Point &start, const Point &dest, int Speed, int Orientation, int flags) const
+Path Map::GetLine(const Point &start, const Point &dest, int Speed, int Orientation, int flags) const
 {
-	PathNode *StartNode = new PathNode;
-	PathNode *Return = StartNode;
-	StartNode->Next = nullptr;
-	StartNode->Parent = nullptr;
-	StartNode->x = start.x;
-	StartNode->y = start.y;
-	StartNode->orient = Orientation;
-
+	Path Return;
 	int Count = 0;
 	int Max = Distance(start, dest);
+	Return.reserve(Max / (Speed + 1) + 2);
+	Return.push_back({ unsigned(start.x), unsigned(start.y), unsigned(Orientation) });
+
 	for (int Steps = 0; Steps < Max; Steps++) {
 		Point p;
 		p.x = start.x + ((dest.x - start.x) * Steps / Max);
@@ -208,18 +194,16 @@ PathNode *Map::GetLine(const Point &start, const Point &dest, int Speed, int Ori
 		}
 
 		if (!Count) {
-			StartNode->Next = new PathNode;
-			StartNode->Next->Parent = StartNode;
-			StartNode = StartNode->Next;
-			StartNode->Next = nullptr;
+			Return.emplace_back();
 			Count = Speed;
 		} else {
 			Count--;
 		}
 
-		StartNode->x = p.x;
-		StartNode->y = p.y;
-		StartNode->orient = Orientation;
+		PathNode &node = Return.back();
+		node.x = p.x;
+		node.y = p.y;
+		node.orient = Orientation;
 		bool wall = bool(GetBlocked(ConvertCoordToTile(p)) & (PathMapFlags::DOOR_IMPASSABLE | PathMapFlags::SIDEWALL));
 		if (wall) switch (flags) {
 			case GL_REBOUND:
@@ -236,24 +220,117 @@ PathNode *Map::GetLine(const Point &start, const Point &dest, int Speed, int Ori
 	return Return;
 }
 
-PathNode *Map::GetLine(const Point &p, int steps, unsigned int orient) const
+Path Map::GetLine(const Point &p, int steps, unsigned int orient) const
 {
-	PathNode *step = new PathNode;
-	step->x = p.x + steps * SEARCHMAP_SQUARE_DIAGONAL * dxRand[orient];
-	step->y = p.y + steps * SEARCHMAP_SQUARE_DIAGONAL * dyRand[orient];
-	step->x = Clamp<unsigned int>(step->x, 1u, (mapSize.w - 1) * 16);
-	step->y = Clamp<unsigned int>(step->y, 1u, (mapSize.h - 1) * 12);
-	step->orient = GetOrient(Point(step->x, step->y), p);
-	step->Next = nullptr;
-	step->Parent = nullptr;
-	return step;
+	PathNode step;
+	step.x = p.x + steps * SEARCHMAP_SQUARE_DIAGONAL * dxRand[orient];
+	step.y = p.y + steps * SEARCHMAP_SQUARE_DIAGONAL * dyRand[orient];
+	step.x = Clamp<unsigned int>(step.x, 1u, (mapSize.w - 1) * 16);
+	step.y = Clamp<unsigned int>(step.y, 1u, (mapSize.h - 1) * 12);
+	step.orient = GetOrient(Point(step.x, step.y), p);
+	return Path(1, step);
 }
 
 // Find a path from start to goal, ending at the specified distance from the
 // target (the goal must be in sight of the end, if PF_SIGHT is specified)
-PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+Path Map::FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+{
+	return FindPath(s, d, size, minDistance, flags, caller, pathWorkspace);
+}
+
+// Only reads the area, so it is safe to run several of these in parallel,
+// as long as each has its own workspace (see ResolvePathRequests)
+Path Map::FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller, PathFinderWorkspace &ws) const
+{
+	ws.LogDebug("FindPath", "s = (%d, %d), d = (%d, %d), caller = %s, dist = %d, size = %d", s.x, s.y, d.x, d.y, caller ? caller->GetName(0) : "nullptr", minDistance, size);
+	Path path;
+	if (core->config.HierarchicalPathfinding) {
+		path = FindPathHierarchical(s, d, size, minDistance, flags, caller, ws);
+		if (!path.empty()) return path;
+	}
+	FindPathDirect(s, d, size, minDistance, flags, caller, ws, &path);
+	return path;
+}
+
+// the search done by Movable::WalkTo
+Path Map::FindWalkPath(const Movable *walker, const Point &d, int minDistance) const
+{
+	return FindWalkPath(walker, d, minDistance, pathWorkspace);
+}
+
+Path Map::FindWalkPath(const Movable *walker, const Point &d, int minDistance, PathFinderWorkspace &ws) const
+{
+	const Actor *actor = nullptr;
+	if (walker->Type == ST_ACTOR) actor = (const Actor *) walker;
+
+	Path newPath = FindPath(walker->Pos, d, walker->size, minDistance, PF_SIGHT|PF_ACTORS_ARE_BLOCKING, actor, ws);
+	if (newPath.empty() && actor && actor->ValidTarget(GA_CAN_BUMP)) {
+		ws.LogDebug("WalkTo", "%s re-pathing ignoring actors", walker->GetName(0));
+		newPath = FindPath(walker->Pos, d, walker->size, minDistance, PF_SIGHT, actor, ws);
+	}
+	return newPath;
+}
+
+// Long walks are first routed over the cluster graph and then refined
+// with Theta* from one cluster entrance to the next. Any failure (e.g. a big
+// creature not fitting through an entrance) is left to the plain search.
+Path Map::FindPathHierarchical(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller, PathFinderWorkspace &ws) const
 {
-	Log(DEBUG, "FindPath", "s = (%d, %d), d = (%d, %d), caller = %s, dist = %d, size = %d", s.x, s.y, d.x, d.y, caller ? caller->GetName(0) : "nullptr", minDistance, size);
+	SearchmapPoint smptSource = ConvertCoordToTile(s);
+	SearchmapPoint smptDest = ConvertCoordToTile(d);
+	if (!pathHierarchy.IsBuilt() || !pathHierarchy.IsLongRoute(smptSource, smptDest)) {
+		return Path();
+	}
+	std::vector<SearchmapPoint> waypoints;
+	if (!pathHierarchy.FindRoute(smptSource, smptDest, waypoints)) {
+		return Path();
+	}
+
+	Path resultPath;
+	Path leg;
+	NavmapPoint nmptFrom = s;
+	for (size_t i = 0; i <= waypoints.size(); i++) {
+		bool finalLeg = i == waypoints.size();
+		NavmapPoint nmptTo = finalLeg ? d : ConvertCoordFromTile(waypoints[i]) + Point(8, 6);
+		if (ConvertCoordToTile(nmptFrom) == ConvertCoordToTile(nmptTo)) continue;
+
+		bool found;
+		if (finalLeg) {
+			found = FindPathDirect(nmptFrom, nmptTo, size, minDistance, flags, caller, ws, &leg);
+		} else {
+			found = FindPathDirect(nmptFrom, nmptTo, size, 0, flags & ~PF_SIGHT, caller, ws, &leg);
+		}
+		if (!found) {
+			return Path();
+		}
+
+		if (!resultPath.empty()) {
+			// straighten the corner at the waypoint if we can
+			NavmapPoint nmptBefore = s;
+			if (resultPath.size() > 1) {
+				const PathNode &before = resultPath[resultPath.size() - 2];
+				nmptBefore = NavmapPoint(before.x, before.y);
+			}
+			NavmapPoint nmptAfter(leg.front().x, leg.front().y);
+			if (IsWalkableTo(nmptBefore, nmptAfter, flags & PF_ACTORS_ARE_BLOCKING)) {
+				resultPath.pop_back();
+				if (flags & PF_BACKAWAY) {
+					leg.front().orient = GetOrient(nmptBefore, nmptAfter);
+				} else {
+					leg.front().orient = GetOrient(nmptAfter, nmptBefore);
+				}
+			}
+		}
+		resultPath.insert(resultPath.end(), leg.begin(), leg.end());
+		nmptFrom = NavmapPoint(resultPath.back().x, resultPath.back().y);
+	}
+	return resultPath;
+}
+
+// Fills path, if given, and returns whether one was found
+bool Map::FindPathDirect(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller, PathFinderWorkspace &ws, Path *path) const
+{
+	if (path) path->clear();
 	NavmapPoint nmptDest = d;
 	NavmapPoint nmptSource = s;
 	if (!(GetBlockedInRadius(d, size) & PathMapFlags::PASSABLE)) {
@@ -264,29 +341,25 @@ PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsig
 		AdjustPositionNavmap(nmptDest);
 	}
 	if (minDistance < size && !(GetBlockedInRadius(nmptDest, size) & (PathMapFlags::PASSABLE | PathMapFlags::ACTOR))) {
-		Log(DEBUG, "FindPath", "%s can't fit in destination", caller ? caller->GetName(0) : "nullptr");
-		return nullptr;
+		ws.LogDebug("FindPath", "%s can't fit in destination", caller ? caller->GetName(0) : "nullptr");
+		return false;
 	}
 	SearchmapPoint smptSource(nmptSource.x / 16, nmptSource.y / 12);
 	SearchmapPoint smptDest(nmptDest.x / 16, nmptDest.y / 12);
-	if (smptDest == smptSource) return nullptr;
+	if (smptDest == smptSource) return false;
 
 	// Initialize data structures
-	FibonacciHeap<PQNode> open;
-	std::vector<bool> isClosed(mapSize.Area(), false);
-	std::vector<NavmapPoint> parents(mapSize.Area(), Point(0, 0));
-	std::vector<unsigned short> distFromStart(mapSize.Area(), std::numeric_limits<unsigned short>::max());
-	distFromStart[smptSource.y * mapSize.w + smptSource.x] = 0;
-	parents[smptSource.y * mapSize.w + smptSource.x] = nmptSource;
-	open.emplace(PQNode(nmptSource, 0));
+	ws.Reset(mapSize);
+	ws.SetDistance(smptSource.y * mapSize.w + smptSource.x, 0);
+	ws.SetParent(smptSource.y * mapSize.w + smptSource.x, nmptSource);
+	ws.PushOpen(PQNode(nmptSource, 0));
 	bool foundPath = false;
 	unsigned int squaredMinDist = minDistance * minDistance;
 
-	while (!open.empty()) {
-		NavmapPoint nmptCurrent = open.top().point;
-		open.pop();
+	while (!ws.OpenEmpty()) {
+		NavmapPoint nmptCurrent = ws.PopOpen().point;
 		SearchmapPoint smptCurrent(nmptCurrent.x / 16, nmptCurrent.y / 12);
-		if (parents[smptCurrent.y * mapSize.w + smptCurrent.x] == Point(0, 0)) {
+		if (ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x) == Point(0, 0)) {
 			continue;
 		}
 
@@ -295,7 +368,7 @@ PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsig
 			foundPath = true;
 			break;
 		} else if (minDistance) {
-			if (parents[smptCurrent.y * mapSize.w + smptCurrent.x] != nmptCurrent &&
+			if (ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x) != nmptCurrent &&
 					SquaredDistance(nmptCurrent, nmptDest) < squaredMinDist) {
 				if (!(flags & PF_SIGHT) || IsVisibleLOS(nmptCurrent, d)) {
 					smptDest = smptCurrent;
@@ -305,7 +378,7 @@ PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsig
 				}
 			}
 		}
-		isClosed[smptCurrent.y * mapSize.w + smptCurrent.x] = true;
+		ws.Close(smptCurrent.y * mapSize.w + smptCurrent.x);
 
 		for (size_t i = 0; i < DEGREES_OF_FREEDOM; i++) {
 			NavmapPoint nmptChild(nmptCurrent.x + 16 * dxAdjacent[i], nmptCurrent.y + 12 * dyAdjacent[i]);
@@ -313,7 +386,7 @@ PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsig
 			// Outside map
 			if (smptChild.x < 0 ||	smptChild.y < 0 || smptChild.x >= mapSize.w || smptChild.y >= mapSize.h) continue;
 			// Already visited
-			if (isClosed[smptChild.y * mapSize.w + smptChild.x]) continue;
+			if (ws.IsClosed(smptChild.y * mapSize.w + smptChild.x)) continue;
 			// If there's an actor, check it can be bumped away
 			Actor* childActor = GetActor(nmptChild, GA_NO_DEAD|GA_NO_UNSCHEDULED);
 			bool childIsUnbumpable = childActor && childActor != caller && (flags & PF_ACTORS_ARE_BLOCKING || !childActor->ValidTarget(GA_ONLY_BUMPABLE));
@@ -326,26 +399,26 @@ PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsig
 			// Weighted heuristic. Finds sub-optimal paths but should be quite a bit faster
 			const float HEURISTIC_WEIGHT = 1.5;
 			SearchmapPoint smptCurrent(nmptCurrent.x / 16, nmptCurrent.y / 12);
-			NavmapPoint nmptParent = parents[smptCurrent.y * mapSize.w + smptCurrent.x];
-			unsigned short oldDist = distFromStart[smptChild.y * mapSize.w + smptChild.x];
+			NavmapPoint nmptParent = ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x);
+			unsigned short oldDist = ws.GetDistance(smptChild.y * mapSize.w + smptChild.x);
 			// Theta-star path if there is LOS
-			if (IsWalkableTo(nmptParent, nmptChild, flags & PF_ACTORS_ARE_BLOCKING, caller)) {
+			if (IsWalkableTo(nmptParent, nmptChild, flags & PF_ACTORS_ARE_BLOCKING)) {
 				SearchmapPoint smptParent(nmptParent.x / 16, nmptParent.y / 12);
-				unsigned short newDist = distFromStart[smptParent.y * mapSize.w + smptParent.x] + Distance(smptParent, smptChild);
+				unsigned short newDist = ws.GetDistance(smptParent.y * mapSize.w + smptParent.x) + Distance(smptParent, smptChild);
 				if (newDist < oldDist) {
-					parents[smptChild.y * mapSize.w + smptChild.x] = nmptParent;
-					distFromStart[smptChild.y * mapSize.w + smptChild.x] = newDist;
+					ws.SetParent(smptChild.y * mapSize.w + smptChild.x, nmptParent);
+					ws.SetDistance(smptChild.y * mapSize.w + smptChild.x, newDist);
 				}
 			// Fall back to A-star path
-			} else if (IsWalkableTo(nmptCurrent, nmptChild, flags & PF_ACTORS_ARE_BLOCKING, caller)) {
-				unsigned short newDist = distFromStart[smptCurrent.y * mapSize.w + smptCurrent.x] + Distance(smptCurrent, smptChild);
+			} else if (IsWalkableTo(nmptCurrent, nmptChild, flags & PF_ACTORS_ARE_BLOCKING)) {
+				unsigned short newDist = ws.GetDistance(smptCurrent.y * mapSize.w + smptCurrent.x) + Distance(smptCurrent, smptChild);
 				if (newDist < oldDist) {
-					parents[smptChild.y * mapSize.w + smptChild.x] = nmptCurrent;
-					distFromStart[smptChild.y * mapSize.w + smptChild.x] = newDist;
+					ws.SetParent(smptChild.y * mapSize.w + smptChild.x, nmptCurrent);
+					ws.SetDistance(smptChild.y * mapSize.w + smptChild.x, newDist);
 				}
 			}
 
-			if (distFromStart[smptChild.y * mapSize.w + smptChild.x] < oldDist) {
+			if (ws.GetDistance(smptChild.y * mapSize.w + smptChild.x) < oldDist) {
 				// Calculate heuristic
 				int xDist = smptChild.x - smptDest.x;
 				int yDist = smptChild.y - smptDest.y;
@@ -355,47 +428,113 @@ PathNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsig
 				int crossProduct = std::abs(xDist * dyCross - yDist * dxCross) >> 3;
 				double distance = std::sqrt(xDist * xDist + yDist * yDist);
 				double heuristic = HEURISTIC_WEIGHT * (distance + crossProduct);
-				double estDist = distFromStart[smptChild.y * mapSize.w + smptChild.x] + heuristic;
+				double estDist = ws.GetDistance(smptChild.y * mapSize.w + smptChild.x) + heuristic;
 				PQNode newNode(nmptChild, estDist);
-				open.emplace(newNode);
+				ws.PushOpen(newNode);
 			}
 		}
 	}
 
 	if (foundPath) {
-		PathNode *resultPath = nullptr;
+		if (!path) return true;
+		// walk back from the destination and flip it around at the end
 		NavmapPoint nmptCurrent = nmptDest;
 		NavmapPoint nmptParent;
 		SearchmapPoint smptCurrent(nmptCurrent.x / 16, nmptCurrent.y / 12);
-		while (!resultPath || nmptCurrent != parents[smptCurrent.y * mapSize.w + smptCurrent.x]) {
-			nmptParent = parents[smptCurrent.y * mapSize.w + smptCurrent.x];
-			PathNode *newStep = new PathNode;
-			newStep->x = nmptCurrent.x;
-			newStep->y = nmptCurrent.y;
-			newStep->Next = resultPath;
-			newStep->Parent = nullptr;
+		while (path->empty() || nmptCurrent != ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x)) {
+			nmptParent = ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x);
+			PathNode newStep;
+			newStep.x = nmptCurrent.x;
+			newStep.y = nmptCurrent.y;
 			if (flags & PF_BACKAWAY) {
-				newStep->orient = GetOrient(nmptParent, nmptCurrent);
+				newStep.orient = GetOrient(nmptParent, nmptCurrent);
 			} else {
-				newStep->orient = GetOrient(nmptCurrent, nmptParent);
+				newStep.orient = GetOrient(nmptCurrent, nmptParent);
 			}
-			if (resultPath) {
-				resultPath->Parent = newStep;
-			}
-			resultPath = newStep;
+			path->push_back(newStep);
 			nmptCurrent = nmptParent;
 
 			smptCurrent.x = nmptCurrent.x / 16;
 			smptCurrent.y = nmptCurrent.y / 12;
 		}
-		return resultPath;
+		std::reverse(path->begin(), path->end());
+		return true;
 	} else if (caller) {
-		Log(DEBUG, "FindPath", "Pathing failed for %s", caller->GetName(0));
+		ws.LogDebug("FindPath", "Pathing failed for %s", caller->GetName(0));
 	} else {
-		Log(DEBUG, "FindPath", "Pathing failed");
+		ws.LogDebug("FindPath", "Pathing failed");
 	}
 
-	return nullptr;
+	return false;
+}
+
+const unsigned short PathFinderWorkspace::UNREACHED;
+
+void PathFinderWorkspace::Reset(const Size &mapSize)
+{
+	size_t area = mapSize.Area();
+	if (nodes.size() != area) {
+		nodes.assign(area, Node());
+		generation = 0;
+	}
+	open.clear();
+	// only on wraparound do we pay for a full clear
+	if (++generation == 0) {
+		std::fill(nodes.begin(), nodes.end(), Node());
+		generation = 1;
+	}
+}
+
+PathFinderWorkspace::Node &PathFinderWorkspace::Touch(size_t idx)
+{
+	Node &node = nodes[idx];
+	if (node.generation != generation) {
+		node = Node();
+		node.generation = generation;
+	}
+	return node;
+}
+
+void PathFinderWorkspace::PushOpen(const PQNode &node)
+{
+	open.push_back(node);
+	std::push_heap(open.begin(), open.end(), std::greater<PQNode>());
+}
+
+PQNode PathFinderWorkspace::PopOpen()
+{
+	std::pop_heap(open.begin(), open.end(), std::greater<PQNode>());
+	PQNode node = open.back();
+	open.pop_back();
+	return node;
+}
+
+void PathFinderWorkspace::LogDebug(const char* owner, const char* message, ...)
+{
+	va_list ap;
+	va_start(ap, message);
+	if (!deferLog) {
+		LogVA(DEBUG, owner, message, ap);
+		va_end(ap);
+		return;
+	}
+
+	va_list ap_copy;
+	va_copy(ap_copy, ap);
+	const size_t len = vsnprintf(nullptr, 0, message, ap_copy);
+	va_end(ap_copy);
+	std::string buf(len + 1, '\0');
+	vsnprintf(&buf[0], len + 1, message, ap);
+	va_end(ap);
+	buf.resize(len);
+	deferredLog.emplace_back(owner, std::move(buf));
+}
+
+std::vector<PathFinderWorkspace::LogEntry> PathFinderWorkspace::TakeLog()
+{
+	std::vector<LogEntry> entries;
+	entries.swap(deferredLog);
+	return entries;
 }
 
 void Map::NormalizeDeltas(double &dx, double &dy, const double &factor)
@@ -22,6 +22,10 @@
 
 #include "Region.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace GemRB {
 
 //searchmap conversion bits
@@ -46,13 +50,15 @@ enum class PathMapFlags : uint8_t {
 };
 
 struct PathNode {
-	PathNode* Parent;
-	PathNode* Next;
 	unsigned int x;
 	unsigned int y;
 	unsigned int orient;
 };
 
+// The steps of a path in walking order, stored contiguously;
+// an empty path means there is none
+using Path = std::vector<PathNode>;
+
 using NavmapPoint = Point;
 using SearchmapPoint = Point;
 
@@ -82,6 +88,53 @@ public:
 
 };
 
+// Scratch memory for Map::FindPath, kept alive between searches.
+// Instead of clearing the per-node arrays for every query, each node carries
+// the generation it was last written in and anything older counts as untouched.
+class PathFinderWorkspace {
+public:
+	// prepares for a new search on a map of the given size
+	void Reset(const Size &mapSize);
+
+	bool IsClosed(size_t idx) const { return IsCurrent(idx) && nodes[idx].closed; }
+	void Close(size_t idx) { Touch(idx).closed = true; }
+	Point GetParent(size_t idx) const { return IsCurrent(idx) ? nodes[idx].parent : Point(0, 0); }
+	void SetParent(size_t idx, const Point &p) { Touch(idx).parent = p; }
+	unsigned short GetDistance(size_t idx) const { return IsCurrent(idx) ? nodes[idx].dist : UNREACHED; }
+	void SetDistance(size_t idx, unsigned short dist) { Touch(idx).dist = dist; }
+
+	// binary min-heap over a reused buffer
+	bool OpenEmpty() const { return open.empty(); }
+	void PushOpen(const PQNode &node);
+	PQNode PopOpen();
+
+	// the debug messages of a search; searches run on the worker threads keep
+	// them for the caller to log on the main thread, since the log feeds the GUI console
+	using LogEntry = std::pair<const char*, std::string>;
+	void DeferLog(bool defer) { deferLog = defer; }
+	void LogDebug(const char* owner, const char* message, ...);
+	std::vector<LogEntry> TakeLog();
+
+private:
+	static const unsigned short UNREACHED = 0xffff;
+
+	struct Node {
+		uint32_t generation = 0;
+		bool closed = false;
+		Point parent;
+		unsigned short dist = UNREACHED;
+	};
+
+	bool IsCurrent(size_t idx) const { return nodes[idx].generation == generation; }
+	Node &Touch(size_t idx);
+
+	std::vector<Node> nodes;
+	std::vector<PQNode> open;
+	uint32_t generation = 0;
+	bool deferLog = false;
+	std::vector<LogEntry> deferredLog;
+};
+
 }
 
 #endif
@@ -0,0 +1,369 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+// Hierarchical pathfinding, see Botea et al., 2004 (HPA*)
+// The abstract graph only tells Map::FindPath which cluster entrances to
+// aim for; the actual path is still produced by Theta* between them.
+
+#include "PathHierarchy.h"
+
+#include "EnumFlags.h"
+#include "globals.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <functional>
+
+namespace GemRB {
+
+const int PathHierarchy::CLUSTER_SIZE;
+const unsigned short PathHierarchy::NO_ROUTE;
+
+// costs are in tenths of a searchmap cell
+constexpr unsigned short STRAIGHT_COST = 10;
+constexpr unsigned short DIAGONAL_COST = 14;
+// stretches of border at least this long get an entrance at both ends
+constexpr int WIDE_ENTRANCE = 6;
+
+constexpr std::array<int, 4> dxSide{{1, 0, -1, 0}};
+constexpr std::array<int, 4> dySide{{0, 1, 0, -1}};
+
+static unsigned int OctileDistance(const SearchmapPoint &a, const SearchmapPoint &b)
+{
+	unsigned int dx = std::abs(a.x - b.x);
+	unsigned int dy = std::abs(a.y - b.y);
+	return STRAIGHT_COST * std::max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy);
+}
+
+void PathHierarchy::Build(const PathMapFlags *map, const Size &size)
+{
+	srchMap = map;
+	mapSize = size;
+	clusterCount.w = (mapSize.w + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	clusterCount.h = (mapSize.h + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	clusters.assign(clusterCount.Area(), Cluster());
+	anyDirty = true;
+	Update();
+}
+
+void PathHierarchy::Invalidate(const SearchmapPoint &p)
+{
+	if (!srchMap || p.x < 0 || p.y < 0 || p.x >= mapSize.w || p.y >= mapSize.h) return;
+
+	// entrances along a border depend on the cells of both clusters
+	int cx = p.x / CLUSTER_SIZE;
+	int cy = p.y / CLUSTER_SIZE;
+	clusters[cy * clusterCount.w + cx].dirty = true;
+	if (p.x % CLUSTER_SIZE == 0 && cx > 0) {
+		clusters[cy * clusterCount.w + cx - 1].dirty = true;
+	} else if (p.x % CLUSTER_SIZE == CLUSTER_SIZE - 1 && cx + 1 < clusterCount.w) {
+		clusters[cy * clusterCount.w + cx + 1].dirty = true;
+	}
+	if (p.y % CLUSTER_SIZE == 0 && cy > 0) {
+		clusters[(cy - 1) * clusterCount.w + cx].dirty = true;
+	} else if (p.y % CLUSTER_SIZE == CLUSTER_SIZE - 1 && cy + 1 < clusterCount.h) {
+		clusters[(cy + 1) * clusterCount.w + cx].dirty = true;
+	}
+	anyDirty = true;
+}
+
+bool PathHierarchy::IsLongRoute(const SearchmapPoint &s, const SearchmapPoint &d) const
+{
+	return std::abs(s.x / CLUSTER_SIZE - d.x / CLUSTER_SIZE) > 1 || std::abs(s.y / CLUSTER_SIZE - d.y / CLUSTER_SIZE) > 1;
+}
+
+bool PathHierarchy::IsPassable(const SearchmapPoint &p) const
+{
+	if (p.x < 0 || p.y < 0 || p.x >= mapSize.w || p.y >= mapSize.h) return false;
+	PathMapFlags flags = srchMap[p.y * mapSize.w + p.x];
+	return bool(flags & (PathMapFlags::PASSABLE | PathMapFlags::TRAVEL)) && !bool(flags & PathMapFlags::DOOR);
+}
+
+int PathHierarchy::ClusterIndex(const SearchmapPoint &p) const
+{
+	return (p.y / CLUSTER_SIZE) * clusterCount.w + p.x / CLUSTER_SIZE;
+}
+
+Region PathHierarchy::ClusterBounds(int idx) const
+{
+	int x = (idx % clusterCount.w) * CLUSTER_SIZE;
+	int y = (idx / clusterCount.w) * CLUSTER_SIZE;
+	return Region(x, y, std::min(CLUSTER_SIZE, mapSize.w - x), std::min(CLUSTER_SIZE, mapSize.h - y));
+}
+
+// Both clusters sharing a border walk it in the same order, so they
+// always agree on where the entrances are
+void PathHierarchy::ScanBorder(int idx, Side side, std::vector<Entrance> &entrances) const
+{
+	Region bounds = ClusterBounds(idx);
+	SearchmapPoint first;
+	SearchmapPoint step;
+	int length;
+	switch (side) {
+		case EAST:
+			first = SearchmapPoint(bounds.x + bounds.w - 1, bounds.y);
+			step = SearchmapPoint(0, 1);
+			length = bounds.h;
+			break;
+		case WEST:
+			first = SearchmapPoint(bounds.x, bounds.y);
+			step = SearchmapPoint(0, 1);
+			length = bounds.h;
+			break;
+		case SOUTH:
+			first = SearchmapPoint(bounds.x, bounds.y + bounds.h - 1);
+			step = SearchmapPoint(1, 0);
+			length = bounds.w;
+			break;
+		default:
+			first = SearchmapPoint(bounds.x, bounds.y);
+			step = SearchmapPoint(1, 0);
+			length = bounds.w;
+			break;
+	}
+
+	SearchmapPoint across(dxSide[side], dySide[side]);
+	int runStart = -1;
+	for (int i = 0; i <= length; i++) {
+		SearchmapPoint inside(first.x + i * step.x, first.y + i * step.y);
+		bool open = i < length && IsPassable(inside) && IsPassable(inside + across);
+		if (open) {
+			if (runStart < 0) runStart = i;
+			continue;
+		}
+		if (runStart < 0) continue;
+
+		int runLength = i - runStart;
+		if (runLength < WIDE_ENTRANCE) {
+			int mid = runStart + runLength / 2;
+			entrances.push_back({ SearchmapPoint(first.x + mid * step.x, first.y + mid * step.y), side });
+		} else {
+			entrances.push_back({ SearchmapPoint(first.x + runStart * step.x, first.y + runStart * step.y), side });
+			entrances.push_back({ SearchmapPoint(first.x + (i - 1) * step.x, first.y + (i - 1) * step.y), side });
+		}
+		runStart = -1;
+	}
+}
+
+void PathHierarchy::FloodCluster(const Region &bounds, const SearchmapPoint &p, std::vector<unsigned short> &dist) const
+{
+	dist.assign(bounds.w * bounds.h, NO_ROUTE);
+	typedef std::pair<unsigned short, int> QueueEntry;
+	std::vector<QueueEntry> open;
+
+	int start = (p.y - bounds.y) * bounds.w + p.x - bounds.x;
+	dist[start] = 0;
+	open.emplace_back(0, start);
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+		QueueEntry current = open.back();
+		open.pop_back();
+		if (current.first > dist[current.second]) continue;
+
+		int x = current.second % bounds.w;
+		int y = current.second / bounds.w;
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if (!dx && !dy) continue;
+				int nx = x + dx;
+				int ny = y + dy;
+				if (nx < 0 || ny < 0 || nx >= bounds.w || ny >= bounds.h) continue;
+				if (!IsPassable(SearchmapPoint(bounds.x + nx, bounds.y + ny))) continue;
+				// no corner cutting
+				if (dx && dy && (!IsPassable(SearchmapPoint(bounds.x + nx, bounds.y + y)) || !IsPassable(SearchmapPoint(bounds.x + x, bounds.y + ny)))) {
+					continue;
+				}
+				unsigned short cost = current.first + (dx && dy ? DIAGONAL_COST : STRAIGHT_COST);
+				int next = ny * bounds.w + nx;
+				if (cost < dist[next]) {
+					dist[next] = cost;
+					open.emplace_back(cost, next);
+					std::push_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+				}
+			}
+		}
+	}
+}
+
+void PathHierarchy::RebuildCluster(int idx)
+{
+	Cluster &cluster = clusters[idx];
+	cluster.entrances.clear();
+	for (Side side : { EAST, SOUTH, WEST, NORTH }) {
+		ScanBorder(idx, side, cluster.entrances);
+	}
+
+	Region bounds = ClusterBounds(idx);
+	size_t count = cluster.entrances.size();
+	cluster.costs.assign(count * count, NO_ROUTE);
+	for (size_t i = 0; i < count; i++) {
+		FloodCluster(bounds, cluster.entrances[i].cell, floodScratch);
+		for (size_t j = 0; j < count; j++) {
+			const SearchmapPoint &cell = cluster.entrances[j].cell;
+			cluster.costs[i * count + j] = floodScratch[(cell.y - bounds.y) * bounds.w + cell.x - bounds.x];
+		}
+	}
+	cluster.dirty = false;
+}
+
+void PathHierarchy::Update()
+{
+	if (!anyDirty) return;
+	for (size_t i = 0; i < clusters.size(); i++) {
+		if (clusters[i].dirty) {
+			RebuildCluster(int(i));
+		}
+	}
+	anyDirty = false;
+}
+
+int PathHierarchy::Neighbour(int idx, Side side) const
+{
+	switch (side) {
+		case EAST: return idx + 1;
+		case WEST: return idx - 1;
+		case SOUTH: return idx + clusterCount.w;
+		default: return idx - clusterCount.w;
+	}
+}
+
+int PathHierarchy::FindPartner(int idx, const Entrance &entrance) const
+{
+	SearchmapPoint cell = entrance.cell + SearchmapPoint(dxSide[entrance.side], dySide[entrance.side]);
+	Side opposite = Side((entrance.side + 2) % 4);
+	const std::vector<Entrance> &candidates = clusters[Neighbour(idx, entrance.side)].entrances;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (candidates[i].side == opposite && candidates[i].cell == cell) {
+			return int(i);
+		}
+	}
+	return -1;
+}
+
+bool PathHierarchy::FindRoute(const SearchmapPoint &s, const SearchmapPoint &d, std::vector<SearchmapPoint> &waypoints)
+{
+	waypoints.clear();
+	if (!srchMap) return false;
+	if (s.x < 0 || s.y < 0 || s.x >= mapSize.w || s.y >= mapSize.h) return false;
+	if (d.x < 0 || d.y < 0 || d.x >= mapSize.w || d.y >= mapSize.h) return false;
+
+	Update();
+
+	int startCluster = ClusterIndex(s);
+	int goalCluster = ClusterIndex(d);
+	if (startCluster == goalCluster) return false;
+
+	std::vector<unsigned short> flood;
+	const Cluster &first = clusters[startCluster];
+	Region bounds = ClusterBounds(startCluster);
+	FloodCluster(bounds, s, flood);
+	std::vector<unsigned short> startCosts(first.entrances.size());
+	for (size_t i = 0; i < first.entrances.size(); i++) {
+		const SearchmapPoint &cell = first.entrances[i].cell;
+		startCosts[i] = flood[(cell.y - bounds.y) * bounds.w + cell.x - bounds.x];
+	}
+
+	const Cluster &last = clusters[goalCluster];
+	bounds = ClusterBounds(goalCluster);
+	FloodCluster(bounds, d, flood);
+	std::vector<unsigned short> goalCosts(last.entrances.size());
+	for (size_t i = 0; i < last.entrances.size(); i++) {
+		const SearchmapPoint &cell = last.entrances[i].cell;
+		goalCosts[i] = flood[(cell.y - bounds.y) * bounds.w + cell.x - bounds.x];
+	}
+
+	// abstract nodes are numbered cluster by cluster, the goal comes last
+	std::vector<int> offsets(clusters.size() + 1, 0);
+	for (size_t i = 0; i < clusters.size(); i++) {
+		offsets[i + 1] = offsets[i] + int(clusters[i].entrances.size());
+	}
+	int goal = offsets.back();
+	std::vector<unsigned int> dist(goal + 1, UINT_MAX);
+	std::vector<int> parents(goal + 1, -1);
+	typedef std::pair<unsigned int, int> QueueEntry;
+	std::vector<QueueEntry> open;
+
+	auto relax = [&](int node, int parent, unsigned int cost, const SearchmapPoint &cell) {
+		if (cost >= dist[node]) return;
+		dist[node] = cost;
+		parents[node] = parent;
+		open.emplace_back(cost + OctileDistance(cell, d), node);
+		std::push_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+	};
+
+	for (size_t i = 0; i < first.entrances.size(); i++) {
+		if (startCosts[i] == NO_ROUTE) continue;
+		relax(offsets[startCluster] + int(i), -1, startCosts[i], first.entrances[i].cell);
+	}
+
+	bool found = false;
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+		int node = open.back().second;
+		open.pop_back();
+		if (node == goal) {
+			found = true;
+			break;
+		}
+
+		int idx = int(std::upper_bound(offsets.begin(), offsets.end(), node) - offsets.begin()) - 1;
+		int local = node - offsets[idx];
+		const Cluster &cluster = clusters[idx];
+		const Entrance &entrance = cluster.entrances[local];
+		unsigned int cost = dist[node];
+
+		size_t count = cluster.entrances.size();
+		for (size_t i = 0; i < count; i++) {
+			unsigned short step = cluster.costs[local * count + i];
+			if (int(i) == local || step == NO_ROUTE) continue;
+			relax(offsets[idx] + int(i), node, cost + step, cluster.entrances[i].cell);
+		}
+
+		int partner = FindPartner(idx, entrance);
+		if (partner >= 0) {
+			int neighbour = Neighbour(idx, entrance.side);
+			relax(offsets[neighbour] + partner, node, cost + STRAIGHT_COST, clusters[neighbour].entrances[partner].cell);
+		}
+
+		if (idx == goalCluster && goalCosts[local] != NO_ROUTE) {
+			relax(goal, node, cost + goalCosts[local], d);
+		}
+	}
+	if (!found) return false;
+
+	// keep only the cells where the route enters a new cluster
+	for (int node = parents[goal]; node >= 0; node = parents[node]) {
+		int idx = int(std::upper_bound(offsets.begin(), offsets.end(), node) - offsets.begin()) - 1;
+		int parent = parents[node];
+		int parentCluster = parent >= 0 ? int(std::upper_bound(offsets.begin(), offsets.end(), parent) - offsets.begin()) - 1 : startCluster;
+		if (parentCluster == idx) continue;
+		// the route often crosses a cluster corner, aiming for the later cell is enough
+		const SearchmapPoint &cell = clusters[idx].entrances[node - offsets[idx]].cell;
+		if (!waypoints.empty() && std::abs(waypoints.back().x - cell.x) <= 1 && std::abs(waypoints.back().y - cell.y) <= 1) {
+			continue;
+		}
+		waypoints.push_back(cell);
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	return true;
+}
+
+}
@@ -0,0 +1,98 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef PATHHIERARCHY_H
+#define PATHHIERARCHY_H
+
+#include "PathFinder.h"
+
+#include <vector>
+
+namespace GemRB {
+
+// A coarse, HPA*-style abstraction of the searchmap used to route long walks.
+// The searchmap is split into square clusters; every passable stretch along a
+// cluster border gets one or two entrance nodes and the walking cost between
+// the entrances of a cluster is precomputed. Only the static part of the map
+// is considered (terrain and doors), actors are left to the refining search.
+class PathHierarchy {
+public:
+	static const int CLUSTER_SIZE = 16;
+
+	PathHierarchy() = default;
+	PathHierarchy(const PathHierarchy&) = delete;
+	PathHierarchy& operator=(const PathHierarchy&) = delete;
+
+	// (re)builds the whole abstraction for a searchmap of the given size
+	void Build(const PathMapFlags *srchMap, const Size &mapSize);
+	// marks the clusters containing the searchmap cell for patching
+	void Invalidate(const SearchmapPoint &p);
+	bool IsBuilt() const { return srchMap != nullptr; }
+	// patches the clusters marked by Invalidate
+	void Update();
+	// true if the two points are far enough apart to be worth an abstract search
+	bool IsLongRoute(const SearchmapPoint &s, const SearchmapPoint &d) const;
+
+	// Finds the sequence of cluster entrance cells leading from s to d,
+	// not including either of them. Returns false if there is no abstract route.
+	// Only reads the graph once it is up to date, so calls may run in parallel after Update.
+	bool FindRoute(const SearchmapPoint &s, const SearchmapPoint &d, std::vector<SearchmapPoint> &waypoints);
+
+private:
+	enum Side { EAST, SOUTH, WEST, NORTH };
+
+	struct Entrance {
+		SearchmapPoint cell;
+		Side side; // the side of the cluster where the matching entrance lies
+	};
+
+	struct Cluster {
+		std::vector<Entrance> entrances;
+		// entrances.size() squared matrix of walking costs
+		std::vector<unsigned short> costs;
+		bool dirty = true;
+	};
+
+	static const unsigned short NO_ROUTE = 0xffff;
+
+	bool IsPassable(const SearchmapPoint &p) const;
+	int ClusterIndex(const SearchmapPoint &p) const;
+	Region ClusterBounds(int idx) const;
+	void ScanBorder(int idx, Side side, std::vector<Entrance> &entrances) const;
+	void RebuildCluster(int idx);
+	// cluster local costs from p to every cell of its cluster
+	void FloodCluster(const Region &bounds, const SearchmapPoint &p, std::vector<unsigned short> &dist) const;
+	int Neighbour(int idx, Side side) const;
+	// local index of the entrance on the other side of the border
+	int FindPartner(int idx, const Entrance &entrance) const;
+
+	const PathMapFlags *srchMap = nullptr;
+	Size mapSize;
+	Size clusterCount;
+	std::vector<Cluster> clusters;
+	bool anyDirty = false;
+
+	// scratch space for rebuilding clusters
+	std::vector<unsigned short> floodScratch;
+};
+
+}
+
+#endif
@@ -51,8 +51,7 @@ Projectile::Projectile()
 	Destination = Pos;
 	Orientation = 0;
 	NewOrientation = 0;
-	path = NULL;
-	step = NULL;
+	step = 0;
 	timeStartStep = 0;
 	phase = P_UNINITED;
 	effects = NULL;
@@ -788,7 +787,7 @@ void Projectile::DoStep(unsigned int walk_speed)
 		}
 	}
 
-	if (!path) {
+	if (path.empty()) {
 		ChangePhase();
 		return;
 	}
@@ -831,15 +830,12 @@ void Projectile::DoStep(unsigned int walk_speed)
 	//path won't be calculated if speed==0
 	walk_speed=1500/walk_speed;
 	ieDword time = core->GetGame()->Ticks;
-	if (!step) {
-		step = path;
-	}
-
-	const PathNode *start = step;
-	while (step->Next && (( time - timeStartStep ) >= walk_speed)) {
+	size_t last = path.size() - 1;
+	size_t start = step;
+	while (step < last && (( time - timeStartStep ) >= walk_speed)) {
 		unsigned int count = Speed;
-		while (step->Next && count) {
-			step = step->Next;
+		while (step < last && count) {
+			++step;
 			--count;
 		}
 		timeStartStep = timeStartStep + walk_speed;
@@ -852,17 +848,18 @@ void Projectile::DoStep(unsigned int walk_speed)
 	if (ExtFlags & PEF_CONTINUE) {
 		// check for every step along the way
 		// the test case is lightning bolt, its a long projectile,
-		LineTarget(start, step->Next);
+		LineTarget(start, step + 1);
 	}
 
-	SetOrientation (step->orient, false);
+	const PathNode &cur = path[step];
+	SetOrientation (cur.orient, false);
 
-	Pos.x=step->x;
-	Pos.y=step->y;
+	Pos.x=cur.x;
+	Pos.y=cur.y;
 	if (travel_handle) {
 		travel_handle->SetPos(Pos);
 	}
-	if (!step->Next) {
+	if (step == last) {
 		ClearPath();
 		NewOrientation = Orientation;
 		ChangePhase();
@@ -876,14 +873,15 @@ void Projectile::DoStep(unsigned int walk_speed)
 		drawSpark = 1;
 	}
 
-	if (step->Next->x > step->x)
-		Pos.x += ((step->Next->x - Pos.x) * (time - timeStartStep) / walk_speed);
+	const PathNode &next = path[step + 1];
+	if (next.x > cur.x)
+		Pos.x += ((next.x - Pos.x) * (time - timeStartStep) / walk_speed);
 	else
-		Pos.x -= ((Pos.x - step->Next->x) * (time - timeStartStep) / walk_speed);
-	if (step->Next->y > step->y)
-		Pos.y += ((step->Next->y - Pos.y) * (time - timeStartStep) / walk_speed);
+		Pos.x -= ((Pos.x - next.x) * (time - timeStartStep) / walk_speed);
+	if (next.y > cur.y)
+		Pos.y += ((next.y - Pos.y) * (time - timeStartStep) / walk_speed);
 	else
-		Pos.y -= ((Pos.y - step->Next->y) * (time - timeStartStep) / walk_speed);
+		Pos.y -= ((Pos.y - next.y) * (time - timeStartStep) / walk_speed);
 
 }
 
@@ -981,14 +979,8 @@ void Projectile::MoveTo(Map *map, const Point &Des)
 
 void Projectile::ClearPath()
 {
-	PathNode* thisNode = path;
-	while (thisNode) {
-		PathNode* nextNode = thisNode->Next;
-		delete( thisNode );
-		thisNode = nextNode;
-	}
-	path = NULL;
-	step = NULL;
+	path.clear();
+	step = 0;
 }
 
 int Projectile::CalculateTargetFlag() const
@@ -1092,30 +1084,31 @@ void Projectile::SetEffectsCopy(const EffectQueue *eq, const Point &source)
 
 void Projectile::LineTarget() const
 {
-	LineTarget(path, nullptr);
+	LineTarget(0, path.size());
 }
 
-void Projectile::LineTarget(const PathNode *beg, const PathNode *end) const
+// checks the steps in [beg, end)
+void Projectile::LineTarget(size_t beg, size_t end) const
 {
-	if (!effects) {
+	if (!effects || beg >= end) {
 		return;
 	}
 
 	Actor *original = area->GetActorByGlobalID(Caster);
 	int targetFlags = CalculateTargetFlag();
-	const PathNode *iter = beg;
+	size_t iter = beg;
 
 	do {
-		const PathNode *first = iter;
-		const PathNode *last = iter;
-		unsigned int orient = first->orient;
-		while (iter && iter != end && iter->orient == orient) {
+		size_t first = iter;
+		size_t last = iter;
+		unsigned int orient = path[first].orient;
+		while (iter != end && path[iter].orient == orient) {
 			last = iter;
-			iter = iter->Next;
+			iter++;
 		}
 
-		const Point s(first->x, first->y);
-		const Point d(last->x, last->y);
+		const Point s(path[first].x, path[first].y);
+		const Point d(path[last].x, path[last].y);
 		const std::vector<Actor *> &actors = area->GetAllActors();
 
 		for (Actor *target : actors) {
@@ -1129,10 +1122,10 @@ void Projectile::LineTarget(const PathNode *beg, const PathNode *end) const
 			if (PersonalLineDistance(s, d, target, &t) > 1) {
 				continue;
 			}
-			if (t < 0.0 && first->Parent != nullptr && first->Parent->orient == orient) {
+			if (t < 0.0 && first > 0 && path[first - 1].orient == orient) {
 				// skip; assume we've hit the target before
 				continue;
-			} else if (t > 1.0 && last->Next != nullptr && last->Next->orient == orient) {
+			} else if (t > 1.0 && last + 1 < path.size() && path[last + 1].orient == orient) {
 				// skip; assume we'll hit it after
 				continue;
 			}
@@ -1148,7 +1141,7 @@ void Projectile::LineTarget(const PathNode *beg, const PathNode *end) const
 				delete eff;
 			}
 		}
-	} while (iter && iter != end);
+	} while (iter != end);
 }
 
 //secondary projectiles target all in the explosion radius
@@ -1681,7 +1674,6 @@ void Projectile::SetupWall()
 void Projectile::DrawLine(const Region& vp, int face, BlitFlags flag)
 {
 	Game *game = core->GetGame();
-	PathNode *iter = path;
 	Holder<Sprite2D> frame;
 	if (game && game->IsTimestopActive() && !(TFlags&PTF_TIMELESS)) {
 		frame = travel[face]->LastFrame();
@@ -1692,15 +1684,14 @@ void Projectile::DrawLine(const Region& vp, int face, BlitFlags flag)
 
 	Color tint2 = tint;
 	if (game) game->ApplyGlobalTint(tint2, flag);
-	while(iter) {
-		Point pos(iter->x - vp.x, iter->y - vp.y);
+	for (const PathNode &node : path) {
+		Point pos(node.x - vp.x, node.y - vp.y);
 
 		if (SFlags&PSF_FLYING) {
 			pos.y-=FLY_HEIGHT;
 		}
 
 		Draw(frame, pos, flag, tint2);
-		iter = iter->Next;
 	}
 }
 
@@ -240,8 +240,8 @@ protected:
 	ieDword timeStartStep;
 	//attributes from moveable object
 	unsigned char Orientation, NewOrientation;
-	PathNode* path; //whole path
-	PathNode* step; //actual step
+	Path path; //whole path
+	size_t step; //index of the actual step in path
 	//similar to normal actors
 	Map *area;
 	Point Pos = Point(-1, -1);
@@ -386,7 +386,7 @@ private:
 	int AddTrail(const ResRef& BAM, const ieByte *pal) const;
 	void DoStep(unsigned int walk_speed);
 	void LineTarget() const;      //line projectiles (walls, scorchers)
-	void LineTarget(const PathNode *beg, const PathNode *end) const;
+	void LineTarget(size_t beg, size_t end) const;
 	void SecondaryTarget(); //area projectiles (circles, cones)
 	void CheckTrigger(unsigned int radius);
 	//calculate target and destination points for a firewall
@@ -24,6 +24,7 @@
 #include "PluginMgr.h"
 #include "Resource.h"
 #include "ResourceDesc.h"
+#include "System/String.h"
 #include "System/StringBuffer.h"
 
 namespace GemRB {
@@ -46,9 +47,45 @@ bool ResourceManager::AddSource(const char *path, const char *description, Plugi
 	} else {
 		searchPath.push_back(source);
 	}
+	ClearLookups();
 	return true;
 }
 
+void ResourceManager::AddSource(const Holder<ResourceSource>& source)
+{
+	searchPath.push_back(source);
+	ClearLookups();
+}
+
+void ResourceManager::ClearLookups()
+{
+	std::lock_guard<std::mutex> l(lookupLock);
+	stableLookups.clear();
+}
+
+size_t ResourceManager::FindStable(const char *ResRef, const char *ext, const Probe &probe) const
+{
+	std::string key{ResRef};
+	key.append(".");
+	key.append(ext);
+	StringToLower(key);
+
+	std::lock_guard<std::mutex> l(lookupLock);
+	auto it = stableLookups.find(key);
+	if (it != stableLookups.end()) {
+		return it->second;
+	}
+
+	size_t found = 0;
+	for (; found < searchPath.size(); ++found) {
+		if (searchPath[found]->IsStable() && probe(*searchPath[found])) {
+			break;
+		}
+	}
+	stableLookups.emplace(std::move(key), found);
+	return found;
+}
+
 static void PrintPossibleFiles(StringBuffer& buffer, const char* ResRef, const TypeID *type)
 {
 	const std::vector<ResourceDesc>& types = PluginMgr::Get()->GetResourceDesc(type);
@@ -61,9 +98,13 @@ bool ResourceManager::Exists(const char *ResRef, SClass_ID type, bool silent) co
 {
 	if (!ResRef || ResRef[0] == '\0')
 		return false;
-	// TODO: check various caches
-	for (const auto& path : searchPath) {
-		if (path->HasResource(ResRef, type)) {
+	size_t stable = FindStable(ResRef, core->TypeExt(type), [&](ResourceSource &source) {
+		return source.HasResource(ResRef, type);
+	});
+	for (size_t i = 0; i < searchPath.size(); ++i) {
+		// stable sources before the first one known to have it can be skipped
+		if (i < stable && searchPath[i]->IsStable()) continue;
+		if (i == stable || searchPath[i]->HasResource(ResRef, type)) {
 			return true;
 		}
 	}
@@ -78,11 +119,14 @@ bool ResourceManager::Exists(const char *ResRef, const TypeID *type, bool silent
 {
 	if (ResRef[0] == '\0')
 		return false;
-	// TODO: check various caches
 	const std::vector<ResourceDesc> &types = PluginMgr::Get()->GetResourceDesc(type);
 	for (const auto& type2 : types) {
-		for (const auto& path : searchPath) {
-			if (path->HasResource(ResRef, type2)) {
+		size_t stable = FindStable(ResRef, type2.GetExt(), [&](ResourceSource &source) {
+			return source.HasResource(ResRef, type2);
+		});
+		for (size_t i = 0; i < searchPath.size(); ++i) {
+			if (i < stable && searchPath[i]->IsStable()) continue;
+			if (i == stable || searchPath[i]->HasResource(ResRef, type2)) {
 				return true;
 			}
 		}
@@ -101,7 +145,12 @@ DataStream* ResourceManager::GetResource(const char* ResRef, SClass_ID type, boo
 {
 	if (!ResRef || ResRef[0] == '\0')
 		return NULL;
-	for (const auto& path : searchPath) {
+	size_t stable = FindStable(ResRef, core->TypeExt(type), [&](ResourceSource &source) {
+		return source.HasResource(ResRef, type);
+	});
+	for (size_t i = 0; i < searchPath.size(); ++i) {
+		const Holder<ResourceSource>& path = searchPath[i];
+		if (i < stable && path->IsStable()) continue;
 		DataStream *ds = path->GetResource(ResRef, type);
 		if (ds) {
 			if (!silent) {
@@ -127,7 +176,12 @@ Resource* ResourceManager::GetResource(const char* ResRef, const TypeID *type, b
 	}
 	const std::vector<ResourceDesc> &types = PluginMgr::Get()->GetResourceDesc(type);
 	for (const auto& type2 : types) {
-		for (const auto& path : searchPath) {
+		size_t stable = FindStable(ResRef, type2.GetExt(), [&](ResourceSource &source) {
+			return source.HasResource(ResRef, type2);
+		});
+		for (size_t i = 0; i < searchPath.size(); ++i) {
+			const Holder<ResourceSource>& path = searchPath[i];
+			if (i < stable && path->IsStable()) continue;
 			DataStream *str = path->GetResource(ResRef, type2);
 			if (!str && useCorrupt && core->UseCorruptedHack) {
 				// don't look at other paths if requested
@@ -27,6 +27,10 @@
 #include "Holder.h"
 #include "ResourceSource.h"
 
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace GemRB {
@@ -48,6 +52,8 @@ public:
 	 * @param[in] type Plugin type used for source.
 	 **/
 	bool AddSource(const char *path, const char *description, PluginID type, int flags=0);
+	/** Add an already set up ResourceSource to the end of the search path */
+	void AddSource(const Holder<ResourceSource>& source);
 
 	/** returns true if resource exists */
 	bool Exists(const char *ResRef, SClass_ID type, bool silent=false) const;
@@ -60,7 +66,18 @@ public:
 	Resource* GetResource(const char* resname, const TypeID *type, bool silent = false, bool useCorrupt = false) const;
 
 private:
+	using Probe = std::function<bool(ResourceSource&)>;
+
+	/** index of the first stable source having the resource, or the search path size */
+	size_t FindStable(const char *ResRef, const char *ext, const Probe &probe) const;
+	/** forget all remembered lookups, once the search path changes */
+	void ClearLookups();
+
 	std::vector<Holder<ResourceSource> > searchPath;
+	// remembered lookups in the stable sources, keyed by lowercase "resref.ext"
+	// and including misses; the others are always asked directly
+	mutable std::unordered_map<std::string, size_t> stableLookups;
+	mutable std::mutex lookupLock;
 };
 
 }
@@ -40,6 +40,8 @@ public:
 	virtual DataStream* GetResource(const char* resname, SClass_ID type) = 0;
 	virtual DataStream* GetResource(const char* resname, const ResourceDesc &type) = 0;
 	const char *GetDescription() const { return description; }
+	/** true if what the source has can't change once it is open, so lookups can be remembered */
+	virtual bool IsStable() const { return false; }
 protected:
 	char *description = nullptr;
 };
@@ -16,10 +16,15 @@
  *
  */
 #include "Interface.h"
-#include "FileCache.h"
+#include "Compressor.h"
+#include "PluginMgr.h"
+#include "ResourceDesc.h"
 #include "System/FileStream.h"
+#include "System/MemoryStream.h"
 #include "SaveGameAREExtractor.h"
 
+#include <algorithm>
+
 namespace GemRB {
 
 SaveGameAREExtractor::SaveGameAREExtractor(SaveGame *saveGame)
@@ -55,7 +60,13 @@ int32_t SaveGameAREExtractor::copyRetainedAREs(DataStream *destStream, bool trac
 	int32_t i = 0;
 
 	size_t relativeLocation = 0;
-	for (auto it = areLocations.cbegin(); it != areLocations.cend(); ++it, ++i) {
+	for (auto it = areLocations.cbegin(); it != areLocations.cend(); ++it) {
+		// the game wrote a newer copy, which gets packed from the cache
+		if (isCached(it->first)) {
+			continue;
+		}
+
+		++i;
 		relativeLocation += 4 + it->first.size() + 1;
 
 		ieDword complen, declen;
@@ -109,43 +120,77 @@ int32_t SaveGameAREExtractor::createCacheBlob() {
 	return areEntries;
 }
 
-int32_t SaveGameAREExtractor::extractARE(const char *name) {
-	std::string key{name};
+std::string SaveGameAREExtractor::entryKey(const char *resname, const char *ext) {
+	std::string key{resname};
+	key.append(".");
+	key.append(ext);
 	StringToLower(key);
-	key.append(".are");
 
-	auto it = areLocations.find(key);
-	if (it != areLocations.cend() && extractByEntry(key, it) != GEM_OK) {
-		return GEM_ERROR;
-	}
+	return key;
+}
+
+bool SaveGameAREExtractor::isCached(const std::string& key) {
+	char path[_MAX_PATH];
+	PathJoin(path, core->config.CachePath, key.c_str(), nullptr);
 
-	return GEM_OK;
+	return file_exists(path);
 }
 
-int32_t SaveGameAREExtractor::extractByEntry(const std::string& key, RegistryT::const_iterator it) {
-	auto saveGameStream = saveGame->GetSave();
-	if (saveGameStream == nullptr) {
-		return GEM_ERROR;
-	}
+void SaveGameAREExtractor::dropEntry(const char *resname, const char *ext) {
+	std::string key = entryKey(resname, ext);
+	areLocations.erase(key);
+	recentEntries.remove_if([&key](const RecentT::value_type& entry) { return entry.first == key; });
+}
 
-	ieDword complen, declen;
-	saveGameStream->Seek(it->second, GEM_STREAM_START);
-	saveGameStream->ReadDword(declen);
-	saveGameStream->ReadDword(complen);
+bool SaveGameAREExtractor::hasEntry(const char *resname, const char *ext) const {
+	return saveGame != nullptr && areLocations.count(entryKey(resname, ext)) > 0;
+}
 
-	DataStream* cached = CacheCompressedStream(saveGameStream, key.c_str(), complen, true);
+DataStream* SaveGameAREExtractor::getEntry(const char *resname, const char *ext) {
+	std::string key = entryKey(resname, ext);
+	auto it = areLocations.find(key);
+	if (saveGame == nullptr || it == areLocations.cend()) {
+		return nullptr;
+	}
 
-	int32_t returnValue = GEM_OK;
-	if (cached != nullptr) {
-		delete cached;
+	auto recent = std::find_if(recentEntries.begin(), recentEntries.end(),
+		[&key](const RecentT::value_type& entry) { return entry.first == key; });
+	if (recent != recentEntries.end()) {
+		recentEntries.splice(recentEntries.begin(), recentEntries, recent);
 	} else {
-		returnValue = GEM_ERROR;
-	}
+		if (!core->IsAvailable(PLUGIN_COMPRESSION_ZLIB)) {
+			Log(ERROR, "SaveGameAREExtractor", "No Compression Manager Available. Cannot Load Compressed File.");
+			return nullptr;
+		}
 
-	delete saveGameStream;
-	areLocations.erase(it);
+		auto saveGameStream = saveGame->GetSave();
+		if (saveGameStream == nullptr) {
+			return nullptr;
+		}
+
+		ieDword complen, declen;
+		saveGameStream->Seek(it->second, GEM_STREAM_START);
+		saveGameStream->ReadDword(declen);
+		saveGameStream->ReadDword(complen);
 
-	return returnValue;
+		DataStream *decompressed = new MemoryStream(key.c_str(), malloc(declen), declen);
+		PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
+		int result = comp->Decompress(decompressed, saveGameStream, complen);
+		delete saveGameStream;
+		if (result != GEM_OK) {
+			Log(ERROR, "SaveGameAREExtractor", "Cannot decompress %s.", key.c_str());
+			delete decompressed;
+			return nullptr;
+		}
+
+		recentEntries.emplace_front(key, std::unique_ptr<DataStream>(decompressed));
+		if (recentEntries.size() > RECENT_ENTRIES) {
+			recentEntries.pop_back();
+		}
+	}
+
+	// clones start at the beginning and own their copy of the data
+	return recentEntries.front().second->Clone();
 }
 
 bool SaveGameAREExtractor::isRunningSaveGame(const SaveGame& otherGame) const
@@ -176,6 +221,7 @@ void SaveGameAREExtractor::changeSaveGame(SaveGame *saveGame) {
 
 	areLocations.clear();
 	newAreLocations.clear();
+	recentEntries.clear();
 }
 
 void SaveGameAREExtractor::updateSaveGame(size_t offset) {
@@ -190,4 +236,40 @@ void SaveGameAREExtractor::updateSaveGame(size_t offset) {
 	}
 }
 
+SaveGameSource::SaveGameSource(SaveGameAREExtractor& extractor)
+	: extractor(extractor)
+{
+	description = strdup("Save game");
+}
+
+SaveGameSource::~SaveGameSource()
+{
+	free(description);
+}
+
+bool SaveGameSource::Open(const char*, const char*)
+{
+	return true;
+}
+
+bool SaveGameSource::HasResource(const char* resname, SClass_ID type)
+{
+	return extractor.hasEntry(resname, core->TypeExt(type));
+}
+
+bool SaveGameSource::HasResource(const char* resname, const ResourceDesc &type)
+{
+	return extractor.hasEntry(resname, type.GetExt());
+}
+
+DataStream* SaveGameSource::GetResource(const char* resname, SClass_ID type)
+{
+	return extractor.getEntry(resname, core->TypeExt(type));
+}
+
+DataStream* SaveGameSource::GetResource(const char* resname, const ResourceDesc &type)
+{
+	return extractor.getEntry(resname, type.GetExt());
+}
+
 }
@@ -19,10 +19,13 @@
 #ifndef SAVE_GAME_ARE_EXTRACTOR_H
 #define SAVE_GAME_ARE_EXTRACTOR_H
 
+#include <list>
+#include <memory>
 #include <unordered_map>
 #include <string>
 
 #include "exports.h"
+#include "ResourceSource.h"
 #include "System/String.h"
 #include "SaveGame.h"
 
@@ -30,15 +33,22 @@ namespace GemRB {
 
 /**
  * This thing knows the currently loaded game, and SAVImporter already told
- * us where to find what ARE files. So we can extract them only when required.
+ * us where to find all of its files. So instead of extracting them to the
+ * cache, they are decompressed into memory only when they are requested.
+ * Once the game writes a file to the cache, that copy takes precedence.
  */
 class GEM_EXPORT SaveGameAREExtractor {
 	private:
 		using RegistryT = std::unordered_map<std::string, unsigned long>;
 
+		// decompressed entries kept around for repeated requests
+		static const size_t RECENT_ENTRIES = 4;
+		using RecentT = std::list<std::pair<std::string, std::unique_ptr<DataStream>>>;
+
 		SaveGame *saveGame;
 		RegistryT areLocations;
 		RegistryT newAreLocations;
+		RecentT recentEntries;
 
 	public:
 		explicit SaveGameAREExtractor(SaveGame *saveGame = nullptr);
@@ -51,14 +61,36 @@ class GEM_EXPORT SaveGameAREExtractor {
 		void changeSaveGame(SaveGame*);
 		int32_t copyRetainedAREs(DataStream*, bool trackLocations = false);
 		int32_t createCacheBlob();
-		int32_t extractARE(const char*);
+		void dropEntry(const char* resname, const char* ext);
+		DataStream* getEntry(const char* resname, const char* ext);
+		bool hasEntry(const char* resname, const char* ext) const;
 		bool isRunningSaveGame(const SaveGame&) const;
 		void registerLocation(const char*, unsigned long);
 		void registerNewLocation(const char*, unsigned long);
 		void updateSaveGame(size_t offset);
 
 	private:
-		int32_t extractByEntry(const std::string&, RegistryT::const_iterator);
+		static std::string entryKey(const char* resname, const char* ext);
+		static bool isCached(const std::string&);
+};
+
+/**
+ * Serves the files of the loaded save game to the ResourceManager. It is
+ * searched right after the cache directory.
+ */
+class GEM_EXPORT SaveGameSource : public ResourceSource {
+	private:
+		SaveGameAREExtractor& extractor;
+
+	public:
+		explicit SaveGameSource(SaveGameAREExtractor&);
+		~SaveGameSource() override;
+
+		bool Open(const char *filename, const char *description) override;
+		bool HasResource(const char* resname, SClass_ID type) override;
+		bool HasResource(const char* resname, const ResourceDesc &type) override;
+		DataStream* GetResource(const char* resname, SClass_ID type) override;
+		DataStream* GetResource(const char* resname, const ResourceDesc &type) override;
 };
 
 }
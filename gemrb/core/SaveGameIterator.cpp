@@ -404,7 +404,7 @@ void SaveGameIterator::PruneQuickSave(const char *folder) const
 }
 
 /** Save game to given directory */
-static bool DoSaveGame(const char *Path, bool overrideRunning)
+static bool DoSaveGame(const char *Path, bool overrideRunning, bool quick)
 {
 	const Game *game = core->GetGame();
 	//saving areas to cache currently in memory
@@ -420,7 +420,7 @@ static bool DoSaveGame(const char *Path, bool overrideRunning)
 
 	//compress files in cache named: .STO and .ARE
 	//no .CRE would be saved in cache
-	if (core->CompressSave(Path, overrideRunning)) {
+	if (core->CompressSave(Path, overrideRunning, quick)) {
 		return false;
 	}
 
@@ -628,7 +628,8 @@ int SaveGameIterator::CreateSaveGame(int index, bool mqs) const
 		return GEM_ERROR;
 	}
 
-	if (!DoSaveGame(Path, overrideRunning)) {
+	// the reserved slots are for quick and auto saves
+	if (!DoSaveGame(Path, overrideRunning, true)) {
 		displaymsg->DisplayConstantString(STR_CANTSAVE, DMC_BG2XPGREEN);
 		gc->SetDisplayText(STR_CANTSAVE, 30);
 		return GEM_ERROR;
@@ -690,7 +691,7 @@ int SaveGameIterator::CreateSaveGame(Holder<SaveGame> save, const char *slotname
 		return GEM_ERROR;
 	}
 
-	if (!DoSaveGame(Path, overrideRunning)) {
+	if (!DoSaveGame(Path, overrideRunning, false)) {
 		displaymsg->DisplayConstantString(STR_CANTSAVE, DMC_BG2XPGREEN);
 		gc->SetDisplayText(STR_CANTSAVE, 30);
 		return GEM_ERROR;
@@ -2905,6 +2905,10 @@ bool Actor::SetStat(unsigned int StatIndex, ieDword Value, int pcf)
 	unsigned int previous = GetSafeStat(StatIndex);
 	if (Modified[StatIndex]!=Value) {
 		Modified[StatIndex] = Value;
+		// RefreshEffects resyncs the index once it is done
+		if (area && !PrevStats && ActorStatIndex::StatSlot(StatIndex) != -1) {
+			area->ActorStatsChanged(this);
+		}
 	}
 	if (previous!=Value) {
 		if (pcf) {
@@ -3168,6 +3172,9 @@ void Actor::RefreshEffects(EffectQueue *fx)
 
 	//move this further down if needed
 	PrevStats = NULL;
+	if (area) {
+		area->ActorStatsChanged(this);
+	}
 
 	for (auto& trigger : triggers) {
 		trigger.flags |= TEF_PROCESSED_EFFECTS;
@@ -5052,6 +5059,8 @@ void Actor::SetMap(Map *map)
 		InternalFlags &=~IF_CLEANUP;
 		return;
 	}
+	// stats may have changed while we were without an area
+	map->ActorStatsChanged(this);
 	InternalFlags &= ~IF_PST_WMAPPING;
 
 	//These functions are called once when the actor is first put in
@@ -8212,21 +8221,40 @@ void Actor::SetRunFlags(ieDword flags)
 
 void Actor::NewPath()
 {
-	if (Destination == Pos) return;
-	// WalkTo's and FindPath's first argument is passed by reference
-	// And we don't want to modify Destination so we use a temporary
-	Point tmp = Destination;
+	if (BeginNewPath()) {
+		EndNewPath(area->FindWalkPath(this, Destination, pathfindingDistance));
+	}
+}
+
+// the part of NewPath before the search; returns false if there's nothing to search for
+bool Actor::BeginNewPath()
+{
+	if (Destination == Pos) return false;
 	if (GetPathTries() > MAX_PATH_TRIES) {
 		ClearPath(true);
 		ResetPathTries();
-		return;
+		return false;
 	}
-	WalkTo(tmp, InternalFlags, pathfindingDistance);
-	if (!GetPath()) {
+
+	ResetPathTries();
+	bool walking = !(InternalFlags & IF_REALLYDIED) && walkScale != 0;
+	if (walking) {
+		ResetCommentTime();
+		walking = BeginWalk(Destination);
+	}
+	if (!walking && GetPath().empty()) {
 		IncrementPathTries();
 	}
+	return walking;
 }
 
+void Actor::EndNewPath(Path &&newPath)
+{
+	EndWalk(std::move(newPath), pathfindingDistance);
+	if (GetPath().empty()) {
+		IncrementPathTries();
+	}
+}
 
 void Actor::WalkTo(const Point &Des, ieDword flags, int MinDistance)
 {
@@ -737,6 +737,9 @@ public:
 					 const Color&, int phase = -1) const;
 	bool Schedule(ieDword gametime, bool checkhide) const;
 	void NewPath();
+	// NewPath split around the search, see Map::RequestPath
+	bool BeginNewPath();
+	void EndNewPath(Path &&newPath);
 	/* overridden method, won't walk if dead */
 	void WalkTo(const Point &Des, ieDword flags, int MinDistance = 0);
 	/* resolve string constant (sound will be altered) */
@@ -1941,8 +1941,7 @@ Movable::Movable(ScriptableType type)
 	Orientation = 0;
 	NewOrientation = 0;
 	StanceID = 0;
-	path = NULL;
-	step = NULL;
+	step = -1;
 	timeStartStep = 0;
 	AttackMovements[0] = 100;
 	AttackMovements[1] = 0;
@@ -1958,7 +1957,7 @@ Movable::Movable(ScriptableType type)
 
 Movable::~Movable(void)
 {
-	if (path) {
+	if (!path.empty()) {
 		ClearPath(true);
 	}
 }
@@ -1968,29 +1967,23 @@ int Movable::GetPathLength() const
 	const PathNode *node = GetNextStep(0);
 	if (!node) return 0;
 
-	int i = 0;
-	while (node->Next) {
-		i++;
-		node = node->Next;
-	}
-	return i;
+	return int(path.size()) - step - 1;
 }
 
-PathNode *Movable::GetNextStep(int x) const
+const PathNode *Movable::GetNextStep(int x) const
 {
-	if (!step) {
+	if (step < 0) {
 		error("GetNextStep", "Hit with step = null");
 	}
-	PathNode *node = step;
-	while(node && x--) {
-		node = node->Next;
+	if (step + x >= int(path.size())) {
+		return nullptr;
 	}
-	return node;
+	return &path[step + x];
 }
 
 Point Movable::GetMostLikelyPosition() const
 {
-	if (!path) {
+	if (path.empty()) {
 		return Pos;
 	}
 
@@ -2073,11 +2066,12 @@ void Movable::SetAttackMoveChances(const ieWord *amc)
 //this could be used for WingBuffet as well
 void Movable::MoveLine(int steps, ieDword orient)
 {
-	if (path || !steps) {
+	if (!path.empty() || !steps) {
 		return;
 	}
 	// DoStep takes care of stopping on walls if necessary
 	path = area->GetLine(Pos, steps, orient);
+	step = -1;
 }
 
 unsigned char Movable::GetNextFace()
@@ -2162,7 +2156,7 @@ void Movable::DoStep(unsigned int walkScale, ieDword time) {
 	if (Type == ST_ACTOR) actor = (const Actor*) this;
 	// Only bump back if not moving
 	// Actors can be bumped while moving if they are backing off
-	if (!path) {
+	if (path.empty()) {
 		if (IsBumped()) {
 			BumpBack();
 		}
@@ -2175,13 +2169,15 @@ void Movable::DoStep(unsigned int walkScale, ieDword time) {
 		timeStartStep = time;
 		return;
 	}
-	if (!step) {
-		step = path;
+	if (step < 0) {
+		step = 0;
 		timeStartStep = time;
 		return;
 	}
 
-	Point nmptStep(step->x, step->y);
+	const PathNode curStep = path[step];
+	bool lastStep = step + 1 == int(path.size());
+	Point nmptStep(curStep.x, curStep.y);
 	double dx = nmptStep.x - Pos.x;
 	double dy = nmptStep.y - Pos.y;
 	Map::NormalizeDeltas(dx, dy, double(gamedata->GetStepTime()) / double(walkScale));
@@ -2199,7 +2195,7 @@ void Movable::DoStep(unsigned int walkScale, ieDword time) {
 
 		if (BlocksSearchMap() && actorInTheWay && actorInTheWay != this && actorInTheWay->BlocksSearchMap()) {
 			// Give up instead of bumping if you are close to the goal
-			if (!(step->Next) && PersonalDistance(nmptStep, this) < MAX_OPERATING_DISTANCE) {
+			if (lastStep && PersonalDistance(nmptStep, this) < MAX_OPERATING_DISTANCE) {
 				ClearPath(true);
 				NewOrientation = Orientation;
 				// Do not call ReleaseCurrentAction() since other actions
@@ -2231,15 +2227,18 @@ void Movable::DoStep(unsigned int walkScale, ieDword time) {
 		Pos.x += dx;
 		Pos.y += dy;
 		oldPos = Pos;
+		if (actor) {
+			area->ActorMoved(actor);
+		}
 		if (actor && BlocksSearchMap()) {
 			area->BlockSearchMap(Pos, size, actor->IsPartyMember() ? PathMapFlags::PC : PathMapFlags::NPC);
 		}
 
-		SetOrientation(step->orient, false);
+		SetOrientation(curStep.orient, false);
 		timeStartStep = time;
 		if (Pos == nmptStep) {
-			if (step->Next) {
-				step = step->Next;
+			if (!lastStep) {
+				step++;
 			} else {
 				ClearPath(true);
 				NewOrientation = Orientation;
@@ -2257,68 +2256,63 @@ void Movable::AdjustPosition()
 
 void Movable::AddWayPoint(const Point &Des)
 {
-	if (!path) {
+	if (path.empty()) {
 		WalkTo(Des);
 		return;
 	}
 	Destination = Des;
-	//it is tempting to use 'step' here, as it could
-	//be about half of the current path already
-	PathNode *endNode = path;
-	while(endNode->Next) {
-		endNode = endNode->Next;
-	}
-	Point p(endNode->x, endNode->y);
+	Point p(path.back().x, path.back().y);
 	area->ClearSearchMapFor(this);
-	PathNode *path2 = area->FindPath(p, Des, size);
+	Path path2 = area->FindPath(p, Des, size);
 	// if the waypoint is too close to the current position, no path is generated
-	if (!path2) {
+	if (path2.empty()) {
 		if (BlocksSearchMap()) {
 			area->BlockSearchMap(Pos, size, IsPC() ? PathMapFlags::PC : PathMapFlags::NPC);
 		}
 		return;
 	}
-	endNode->Next = path2;
-	//probably it is wise to connect it both ways?
-	path2->Parent = endNode;
+	path.insert(path.end(), path2.begin(), path2.end());
 }
 
 // This function is called at each tick if an actor is following another actor
 // Therefore it's rate-limited to avoid actors being stuck as they keep pathfinding
 void Movable::WalkTo(const Point &Des, int distance)
+{
+	if (!BeginWalk(Des)) return;
+	EndWalk(area->FindWalkPath(this, Des, distance), distance);
+}
+
+// the part of WalkTo before the search; returns false if there's nothing to search for
+bool Movable::BeginWalk(const Point &Des)
 {
 	// Only rate-limit when moving
-	if ((GetPath() || InMove()) && prevTicks && Ticks < prevTicks + 2) {
-		return;
+	if ((!path.empty() || InMove()) && prevTicks && Ticks < prevTicks + 2) {
+		return false;
 	}
 
-	const Actor *actor = nullptr;
-	if (Type == ST_ACTOR) actor = (const Actor*) this;
-
 	prevTicks = Ticks;
 	Destination = Des;
 	if (pathAbandoned) {
 		Log(DEBUG, "WalkTo", "%s: Path was just abandoned", GetName(0));
 		ClearPath(true);
-		return;
+		return false;
 	}
 
 	if (Pos.x / 16 == Des.x / 16 && Pos.y / 12 == Des.y / 12) {
 		ClearPath(true);
-		return;
+		return false;
 	}
 
 	if (BlocksSearchMap()) area->ClearSearchMapFor(this);
-	PathNode *newPath = area->FindPath(Pos, Des, size, distance, PF_SIGHT|PF_ACTORS_ARE_BLOCKING, actor);
-	if (!newPath && actor && actor->ValidTarget(GA_CAN_BUMP)) {
-		Log(DEBUG, "WalkTo", "%s re-pathing ignoring actors", GetName(0));
-		newPath = area->FindPath(Pos, Des, size, distance, PF_SIGHT, actor);
-	}
+	return true;
+}
 
-	if (newPath) {
+void Movable::EndWalk(Path &&newPath, int distance)
+{
+	if (!newPath.empty()) {
 		ClearPath(false);
-		path = newPath;
-		step = path;
+		path = std::move(newPath);
+		step = 0;
 	}  else {
 		pathfindingDistance = std::max(size, distance);
 		if (BlocksSearchMap()) {
@@ -2332,11 +2326,12 @@ void Movable::RunAwayFrom(const Point &Des, int PathLength, bool noBackAway)
 	ClearPath(true);
 	area->ClearSearchMapFor(this);
 	path = area->RunAway(Pos, Des, size, PathLength, !noBackAway, Type == ST_ACTOR ? (Actor*)this : NULL);
+	step = -1;
 }
 
 void Movable::RandomWalk(bool can_stop, bool run)
 {
-	if (path) {
+	if (!path.empty()) {
 		return;
 	}
 	//if not continous random walk, then stops for a while
@@ -2392,11 +2387,12 @@ void Movable::RandomWalk(bool can_stop, bool run)
 	//the 5th parameter is controlling the orientation of the actor
 	//0 - back away, 1 - face direction
 	path = area->RandomWalk(Pos, size, maxWalkDistance ? maxWalkDistance : 5, Type == ST_ACTOR ? (Actor*)this : NULL);
+	step = -1;
 	if (BlocksSearchMap()) {
 		area->BlockSearchMap(Pos, size, IsPC() ? PathMapFlags::PC : PathMapFlags::NPC);
 	}
-	if (path) {
-		Destination = Point(path->x, path->y);
+	if (!path.empty()) {
+		Destination = Point(path.front().x, path.front().y);
 	} else {
 		randomWalkCounter = 0;
 		WalkTo(HomeLocation);
@@ -2411,6 +2407,9 @@ void Movable::MoveTo(const Point &Des)
 	Pos = Des;
 	oldPos = Des;
 	Destination = Des;
+	if (Type == ST_ACTOR) {
+		area->ActorMoved((const Actor *) this);
+	}
 	if (BlocksSearchMap()) {
 		area->BlockSearchMap( Pos, size, IsPC()?PathMapFlags::PC:PathMapFlags::NPC);
 	}
@@ -2437,14 +2436,8 @@ void Movable::ClearPath(bool resetDestination)
 		}
 		InternalFlags &= ~IF_NORETICLE;
 	}
-	PathNode* thisNode = path;
-	while (thisNode) {
-		PathNode* nextNode = thisNode->Next;
-		delete( thisNode );
-		thisNode = nextNode;
-	}
-	path = NULL;
-	step = NULL;
+	path.clear();
+	step = -1;
 	//don't call ReleaseCurrentAction
 }
 
@@ -24,6 +24,7 @@
 #include "exports.h"
 
 #include "CharAnimations.h"
+#include "PathFinder.h"
 #include "Variables.h"
 
 #include <list>
@@ -43,7 +44,6 @@ class InfoPoint;
 class Map;
 class Movable;
 class Object;
-struct PathNode;
 class Scriptable;
 class Selectable;
 class Spell;
@@ -472,8 +472,8 @@ private: //these seem to be sensitive, so get protection
 	unsigned char Orientation, NewOrientation;
 	ieWord AttackMovements[3];
 
-	PathNode* path; //whole path
-	PathNode* step; //actual step
+	Path path; //whole path
+	int step; //index of the actual step in path, -1 if not walking it yet
 	unsigned int prevTicks;
 	int bumpBackTries;
 	bool pathAbandoned;
@@ -508,18 +508,19 @@ public:
 	void BumpAway();
 	void BumpBack();
 	inline bool IsBumped() const { return bumped; }
-	PathNode *GetNextStep(int x) const;
-	inline PathNode *GetPath() const { return path; };
+	const PathNode *GetNextStep(int x) const;
+	inline const Path &GetPath() const { return path; };
 	inline int GetPathTries() const	{ return pathTries; }
 	inline void IncrementPathTries() { pathTries++; }
 	inline void ResetPathTries() { pathTries = 0; }
+	inline int GetPathfindingDistance() const { return pathfindingDistance; }
 	int GetPathLength() const;
 //inliners to protect data consistency
-	inline PathNode * GetStep() {
-		if (!step) {
+	inline const PathNode *GetStep() {
+		if (step < 0) {
 			DoStep((unsigned int) ~0);
 		}
-		return step;
+		return step < 0 ? nullptr : &path[step];
 	}
 
 	inline bool IsMoving() const {
@@ -546,6 +547,9 @@ public:
 	int GetRandomWalkCounter() const { return randomWalkCounter; };
 	void MoveLine(int steps, ieDword Orient);
 	void WalkTo(const Point &Des, int MinDistance = 0);
+	// WalkTo split around the search, for when it is done elsewhere
+	bool BeginWalk(const Point &Des);
+	void EndWalk(Path &&newPath, int MinDistance);
 	void MoveTo(const Point &Des);
 	void Stop() override;
 	void ClearPath(bool resetDestination = true);
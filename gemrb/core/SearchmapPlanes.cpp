@@ -0,0 +1,131 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "SearchmapPlanes.h"
+
+#include "EnumFlags.h"
+
+namespace GemRB {
+
+const unsigned int SearchmapPlanes::MAX_RADIUS;
+const int SearchmapPlanes::PLANE_COUNT;
+const int SearchmapPlanes::IMPASSABLE_PLANE;
+
+// indexed by radius and row distance from the centre
+const uint8_t SearchmapPlanes::circleSpans[MAX_RADIUS + 1][MAX_RADIUS + 1] = {
+	{ 0 },
+	{ 1, 1 },
+	{ 2, 2, 1 },
+	{ 3, 3, 2, 1 },
+	{ 4, 4, 3, 2, 1 },
+	{ 5, 5, 4, 4, 3, 1 },
+	{ 6, 6, 5, 5, 4, 3, 1 },
+	{ 7, 7, 6, 6, 5, 5, 3, 1 }
+};
+
+// same as Map::GetBlocked
+static uint8_t BlockingStatus(PathMapFlags raw)
+{
+	if (bool(raw & (PathMapFlags::DOOR_IMPASSABLE|PathMapFlags::ACTOR))) {
+		raw &= ~PathMapFlags::PASSABLE;
+	}
+	if (bool(raw & PathMapFlags::DOOR_OPAQUE)) {
+		raw = PathMapFlags::SIDEWALL;
+	}
+	return uint8_t(raw);
+}
+
+void SearchmapPlanes::Build(const PathMapFlags *srchMap, const Size &size)
+{
+	mapSize = size;
+	wordsPerRow = (mapSize.w + 63) / 64;
+	words.assign(wordsPerRow * mapSize.h * PLANE_COUNT, 0);
+	for (int y = 0; y < mapSize.h; ++y) {
+		for (int x = 0; x < mapSize.w; ++x) {
+			Update(SearchmapPoint(x, y), srchMap[y * mapSize.w + x]);
+		}
+	}
+}
+
+void SearchmapPlanes::Update(const SearchmapPoint &p, PathMapFlags raw)
+{
+	if (p.x < 0 || p.y < 0 || p.x >= mapSize.w || p.y >= mapSize.h) {
+		return;
+	}
+
+	uint64_t *planes = &words[WordIndex(p.x, p.y)];
+	uint64_t bit = uint64_t(1) << (p.x % 64);
+	uint8_t status = BlockingStatus(raw);
+	for (int plane = 0; plane < IMPASSABLE_PLANE; ++plane) {
+		if (status & (1 << plane)) {
+			planes[plane] |= bit;
+		} else {
+			planes[plane] &= ~bit;
+		}
+	}
+	if (status == uint8_t(PathMapFlags::IMPASSABLE)) {
+		planes[IMPASSABLE_PLANE] |= bit;
+	} else {
+		planes[IMPASSABLE_PLANE] &= ~bit;
+	}
+}
+
+bool SearchmapPlanes::Covers(const SearchmapPoint &p, unsigned int radius) const
+{
+	int r = radius;
+	return p.x >= r && p.y >= r && p.x + r < mapSize.w && p.y + r < mapSize.h;
+}
+
+PathMapFlags SearchmapPlanes::QueryCircle(const SearchmapPoint &p, unsigned int radius, bool &anyImpassable) const
+{
+	uint64_t acc[PLANE_COUNT] = {};
+	int r = radius;
+	for (int dy = -r; dy <= r; ++dy) {
+		int span = CircleSpan(radius, dy);
+		int x0 = p.x - span;
+		int x1 = p.x + span;
+		const uint64_t *planes = &words[WordIndex(x0, p.y + dy)];
+		uint64_t mask = ~uint64_t(0) << (x0 % 64);
+		if (x0 / 64 == x1 / 64) {
+			mask &= ~uint64_t(0) >> (63 - x1 % 64);
+			for (int plane = 0; plane < PLANE_COUNT; ++plane) {
+				acc[plane] |= planes[plane] & mask;
+			}
+		} else {
+			// spans are at most 15 cells wide, so two words are enough
+			const uint64_t *next = planes + PLANE_COUNT;
+			uint64_t nextMask = ~uint64_t(0) >> (63 - x1 % 64);
+			for (int plane = 0; plane < PLANE_COUNT; ++plane) {
+				acc[plane] |= (planes[plane] & mask) | (next[plane] & nextMask);
+			}
+		}
+	}
+
+	uint8_t ret = 0;
+	for (int plane = 0; plane < IMPASSABLE_PLANE; ++plane) {
+		if (acc[plane]) {
+			ret |= 1 << plane;
+		}
+	}
+	anyImpassable = acc[IMPASSABLE_PLANE] != 0;
+	return PathMapFlags(ret);
+}
+
+}
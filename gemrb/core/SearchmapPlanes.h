@@ -0,0 +1,73 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef SEARCHMAPPLANES_H
+#define SEARCHMAPPLANES_H
+
+#include "PathFinder.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace GemRB {
+
+// A bit packed copy of the blocking status of every searchmap cell (what
+// Map::GetBlocked returns), split into one plane per flag and a plane of
+// fully impassable cells. Circle queries then only need to mask a couple of
+// words per row instead of looking up every cell on its own.
+class SearchmapPlanes {
+public:
+	// the biggest circle radius there is a span table for (MAX_CIRCLESIZE - 1)
+	static const unsigned int MAX_RADIUS = 7;
+
+	SearchmapPlanes() = default;
+	SearchmapPlanes(const SearchmapPlanes&) = delete;
+	SearchmapPlanes& operator=(const SearchmapPlanes&) = delete;
+
+	void Build(const PathMapFlags *srchMap, const Size &mapSize);
+	// call with the new raw searchmap value of the cell
+	void Update(const SearchmapPoint &p, PathMapFlags raw);
+
+	// half width of the circle of the given radius, dy rows away from the centre
+	// uses the same approximation as the old per cell loops: i*i + dy*dy <= radius*radius + 1
+	static int CircleSpan(unsigned int radius, int dy) { return circleSpans[radius][dy < 0 ? -dy : dy]; }
+	// true if the whole circle lies on the map
+	bool Covers(const SearchmapPoint &p, unsigned int radius) const;
+	// ORs the blocking status of all the cells in the circle and reports
+	// if any of them was impassable; the circle must be covered
+	PathMapFlags QueryCircle(const SearchmapPoint &p, unsigned int radius, bool &anyImpassable) const;
+
+private:
+	// one plane per PathMapFlags bit, then the impassable plane
+	static const int PLANE_COUNT = 9;
+	static const int IMPASSABLE_PLANE = 8;
+	static const uint8_t circleSpans[MAX_RADIUS + 1][MAX_RADIUS + 1];
+
+	// the planes of a word are stored next to each other
+	size_t WordIndex(int x, int y) const { return (y * wordsPerRow + x / 64) * PLANE_COUNT; }
+
+	Size mapSize;
+	size_t wordsPerRow = 0;
+	std::vector<uint64_t> words;
+};
+
+}
+
+#endif
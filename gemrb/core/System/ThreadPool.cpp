@@ -0,0 +1,98 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "System/ThreadPool.h"
+
+namespace GemRB {
+
+ThreadPool::ThreadPool(unsigned int helperCount)
+{
+	for (unsigned int i = 0; i < helperCount; ++i) {
+		helpers.emplace_back([this, i] { HelperLoop(i + 1); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> l(lock);
+		running = false;
+	}
+	wakeup.notify_all();
+	for (auto& helper : helpers) {
+		helper.join();
+	}
+}
+
+void ThreadPool::HelperLoop(unsigned int thread)
+{
+	unsigned long seen = 0;
+	while (true) {
+		std::unique_lock<std::mutex> lk(lock);
+		wakeup.wait(lk, [this, seen]() { return !running || generation != seen; });
+		if (!running) return;
+		seen = generation;
+		lk.unlock();
+
+		RunItems(thread);
+
+		lk.lock();
+		if (--busyHelpers == 0) {
+			idle.notify_all();
+		}
+	}
+}
+
+void ThreadPool::RunItems(unsigned int thread)
+{
+	size_t item;
+	while ((item = nextItem++) < itemCount) {
+		(*job)(item, thread);
+	}
+}
+
+void ThreadPool::ParallelFor(size_t count, const Job &newJob)
+{
+	std::unique_lock<std::mutex> caller(callerLock, std::try_to_lock);
+	if (helpers.empty() || count < 2 || !caller.owns_lock()) {
+		for (size_t i = 0; i < count; ++i) {
+			newJob(i, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> l(lock);
+		job = &newJob;
+		itemCount = count;
+		nextItem = 0;
+		busyHelpers = ThreadCount();
+		++generation;
+	}
+	wakeup.notify_all();
+
+	RunItems(0);
+
+	// every helper has to check in, so none of them can still be looking
+	// at this job once the next one is set up
+	std::unique_lock<std::mutex> lk(lock);
+	idle.wait(lk, [this]() { return busyHelpers == 0; });
+	job = nullptr;
+}
+
+}
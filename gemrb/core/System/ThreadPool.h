@@ -0,0 +1,79 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * @file ThreadPool.h
+ * A small pool of persistent helper threads for data parallel jobs
+ * @author The GemRB Project
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "exports.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GemRB {
+
+class GEM_EXPORT ThreadPool final {
+public:
+	// called with the item index and the index of the thread running it,
+	// 0 being the calling thread and 1..ThreadCount() the helpers
+	using Job = std::function<void(size_t item, unsigned int thread)>;
+
+	// with no helper threads every job runs synchronously on the caller
+	explicit ThreadPool(unsigned int helperCount);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned int ThreadCount() const { return (unsigned int) helpers.size(); }
+
+	// runs job for every item in [0, count) and returns once all of them are done;
+	// the calling thread takes part too, so it is never just idling
+	// while a job is running, other calls (nested or from other threads) run serially
+	void ParallelFor(size_t count, const Job &job);
+
+private:
+	void HelperLoop(unsigned int thread);
+	void RunItems(unsigned int thread);
+
+	std::vector<std::thread> helpers;
+	std::mutex callerLock;
+	std::mutex lock;
+	std::condition_variable wakeup;
+	std::condition_variable idle;
+	bool running = true;
+	unsigned long generation = 0;
+	unsigned int busyHelpers = 0;
+
+	const Job *job = nullptr;
+	size_t itemCount = 0;
+	std::atomic<size_t> nextItem {0};
+};
+
+}
+
+#endif
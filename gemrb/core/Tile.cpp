@@ -20,6 +20,8 @@
 
 #include "Tile.h"
 
+#include "TileSetMgr.h"
+
 namespace GemRB {
 
 Tile::Tile(Animation* anim, Animation* sec)
@@ -35,4 +37,28 @@ Tile::~Tile(void)
 	delete( anim[1] );
 }
 
+void Tile::DeferFrames(TileSetMgr* set, const unsigned short* indexes, int count,
+	const unsigned short* secondary)
+{
+	tileset = set;
+	frameIndexes[0].assign(indexes, indexes + count);
+	if (secondary) {
+		frameIndexes[1].assign(secondary, secondary + count);
+	}
+}
+
+bool Tile::LoadFrames()
+{
+	if (!tileset) return false;
+
+	for (int i = 0; i < 2; i++) {
+		for (size_t f = 0; f < frameIndexes[i].size(); f++) {
+			anim[i]->AddFrame(tileset->GetTile(frameIndexes[i][f]), f);
+		}
+		std::vector<unsigned short>().swap(frameIndexes[i]);
+	}
+	tileset = nullptr;
+	return true;
+}
+
 }
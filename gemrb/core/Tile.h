@@ -26,12 +26,24 @@
 
 #include "Animation.h"
 
+#include <vector>
+
 namespace GemRB {
 
+class TileSetMgr;
+
 class GEM_EXPORT Tile {
 public:
 	explicit Tile(Animation* anim, Animation* sec = nullptr);
 	~Tile(void);
+	/** leaves the frames to be decoded from the tileset on first use,
+	 * the owner of the tile has to keep the tileset alive until then */
+	void DeferFrames(TileSetMgr* tileset, const unsigned short* indexes, int count,
+		const unsigned short* secondary = nullptr);
+	/** decodes the frames of a deferred tile, returns false if there was nothing to do */
+	bool LoadFrames();
+	/** the tileset of a tile that wasn't decoded yet */
+	TileSetMgr* DeferredTileSet() const { return tileset; }
 	unsigned char tileIndex;
 	unsigned char om;
 	Color SearchMap[16]{};
@@ -39,6 +51,9 @@ public:
 	Color LightMap[16]{};
 	Color NLightMap[16]{};
 	Animation* anim[2];
+private:
+	TileSetMgr* tileset = nullptr;
+	std::vector<unsigned short> frameIndexes[2];
 };
 
 }
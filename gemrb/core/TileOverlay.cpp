@@ -45,6 +45,38 @@ TileOverlay::~TileOverlay(void)
 void TileOverlay::AddTile(Tile* tile)
 {
 	tiles[count++] = tile;
+	overlayMask |= tile->om;
+
+	TileSetMgr* set = tile->DeferredTileSet();
+	if (set) {
+		assert(!tileset || tileset.get() == set);
+		tileset = Holder<TileSetMgr>(set);
+		deferredTiles++;
+	}
+}
+
+void TileOverlay::LoadTile(Tile* tile) const
+{
+	if (tile->LoadFrames() && --deferredTiles == 0) {
+		tileset = nullptr;
+	}
+}
+
+// decode tiles this many tiles away from the viewport already, so scrolling
+// doesn't have to do all the work for a whole new row at once
+#define PREFETCH_TILES 2
+
+void TileOverlay::LoadTiles(int sx, int sy, int dx, int dy) const
+{
+	sx = std::max(sx - PREFETCH_TILES, 0);
+	sy = std::max(sy - PREFETCH_TILES, 0);
+	dx = std::min(dx + PREFETCH_TILES, w);
+	dy = std::min(dy + PREFETCH_TILES, h);
+	for (int y = sy; y < dy; y++) {
+		for (int x = sx; x < dx; x++) {
+			LoadTile(tiles[y * w + x]);
+		}
+	}
 }
 
 void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlay*> &overlays, BlitFlags flags) const
@@ -54,6 +86,7 @@ void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlay*> &overla
 	int sy = std::max(viewport.y / 64, 0);
 	int dx = ( std::max(viewport.x, 0) + viewport.w + 63 ) / 64;
 	int dy = ( std::max(viewport.y, 0) + viewport.h + 63 ) / 64;
+	LoadTiles(sx, sy, dx, dy);
 
 	Game* game = core->GetGame();
 	assert(game);
@@ -63,7 +96,25 @@ void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlay*> &overla
 	}
 	const Color tintcol = globalTint ? * globalTint : Color();
 
+	// the current frame of every overlay (water etc.) any of our tiles uses;
+	// bit z of a tile's overlay mask stands for overlays[z]
+	int activeMask = 0;
+	std::vector<Holder<Sprite2D>> ovFrames(overlays.size());
+	for (size_t z = 1; z < overlays.size(); z++) {
+		const TileOverlay* ov = overlays[z];
+		if (!ov || ov->count == 0 || !(overlayMask & (1 << z))) {
+			continue;
+		}
+		Tile* ovtile = ov->tiles[0]; //allow only 1x1 tiles now
+		ov->LoadTile(ovtile);
+		ovFrames[z] = ovtile->anim[0]->NextFrame();
+		activeMask |= 1 << z;
+	}
+
+	// tiles get blended with the water differently in BG1
+	bool layered = core->HasFeature(GF_LAYERED_WATER_TILES);
 	Video* vid = core->GetVideoDriver();
+	overlaid.clear();
 	for (int y = sy; y < dy && y < h; y++) {
 		for (int x = sx; x < dx && x < w; x++) {
 			Tile* tile = tiles[( y* w ) + x];
@@ -77,37 +128,46 @@ void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlay*> &overla
 
 			// this is the base terrain tile
 			Point p = Point(x * 64, y * 64) - viewport.origin;
-			vid->BlitGameSprite(anim->NextFrame(), p, flags, tintcol);
+			Holder<Sprite2D> frame = anim->NextFrame();
+			vid->BlitGameSprite(frame, p, flags, tintcol);
 
-			if (!tile->om || tile->tileIndex) {
+			if (tile->tileIndex || !(tile->om & activeMask)) {
 				continue;
 			}
+			if (!layered) {
+				// in BG 1 the terrain tile itself is the mask to blend it with the water
+				overlaid.push_back({ p, tile->om & activeMask, frame });
+			} else if (tile->anim[1]) {
+				// this is the mask to blend the terrain tile with the water for everything but BG1
+				overlaid.push_back({ p, tile->om & activeMask, tile->anim[1]->NextFrame() });
+			} else {
+				overlaid.push_back({ p, tile->om & activeMask, nullptr });
+			}
+		}
+	}
+	if (overlaid.empty()) {
+		return;
+	}
 
-			int mask = 2;
-			for (size_t z = 1;z<overlays.size();z++) {
-				TileOverlay * ov = overlays[z];
-				if (ov && ov->count > 0) {
-					Tile *ovtile = ov->tiles[0]; //allow only 1x1 tiles now
-					if (tile->om & mask) {
-						//draw overlay tiles, they should be half transparent except for BG1
-						BlitFlags transFlag = (core->HasFeature(GF_LAYERED_WATER_TILES)) ? BlitFlags::HALFTRANS : BlitFlags::NONE;
-						// this is the water (or whatever)
-						vid->BlitGameSprite(ovtile->anim[0]->NextFrame(), p, flags | transFlag, tintcol);
-
-						if (core->HasFeature(GF_LAYERED_WATER_TILES)) {
-							if (tile->anim[1]) {
-								// this is the mask to blend the terrain tile with the water for everything but BG1
-								vid->BlitGameSprite(tile->anim[1]->NextFrame(), p,
-													flags | BlitFlags::BLENDED, tintcol);
-							}
-						} else {
-							// in BG 1 this is the mask to blend the terrain tile with the water
-							vid->BlitGameSprite(tile->anim[0]->NextFrame(), p,
-												flags | BlitFlags::BLENDED, tintcol);
-						}
-					}
-				}
-				mask<<=1;
+	// the overlays get their own pass, so the same water frame is blitted in
+	// a row; tiles don't overlap, so the result is the same as drawing them
+	// right after their terrain tile
+	//draw overlay tiles, they should be half transparent except for BG1
+	BlitFlags transFlag = layered ? BlitFlags::HALFTRANS : BlitFlags::NONE;
+	for (size_t z = 1; z < overlays.size(); z++) {
+		int mask = 1 << z;
+		if (!(activeMask & mask)) {
+			continue;
+		}
+		// this is the water (or whatever)
+		for (const OverlaidTile& ot : overlaid) {
+			if (ot.om & mask) {
+				vid->BlitGameSprite(ovFrames[z], ot.pos, flags | transFlag, tintcol);
+			}
+		}
+		for (const OverlaidTile& ot : overlaid) {
+			if ((ot.om & mask) && ot.mask) {
+				vid->BlitGameSprite(ot.mask, ot.pos, flags | BlitFlags::BLENDED, tintcol);
 			}
 		}
 	}
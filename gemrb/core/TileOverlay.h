@@ -24,6 +24,7 @@
 #include "exports.h"
 
 #include "Tile.h"
+#include "TileSetMgr.h"
 #include "Video/Video.h"
 
 #include <vector>
@@ -41,6 +42,25 @@ public:
 	~TileOverlay(void);
 	void AddTile(Tile* tile);
 	void Draw(const Region& viewport, std::vector<TileOverlay*> &overlays, BlitFlags flags) const;
+private:
+	// a visible tile with overlays and the frame blending it with them
+	struct OverlaidTile {
+		Point pos;
+		int om;
+		Holder<Sprite2D> mask;
+	};
+	// which overlays any of the tiles use
+	int overlayMask = 0;
+	// scratch space for Draw, kept to avoid reallocating it every frame
+	mutable std::vector<OverlaidTile> overlaid;
+	// the tileset the tiles decode from; it and its stream are only kept
+	// while some tiles are still undecoded, or until the area is unloaded
+	mutable Holder<TileSetMgr> tileset;
+	mutable int deferredTiles = 0;
+
+	/** decodes the tiles in the given range and a margin around it */
+	void LoadTiles(int sx, int sy, int dx, int dy) const;
+	void LoadTile(Tile* tile) const;
 };
 
 }
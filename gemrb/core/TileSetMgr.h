@@ -22,6 +22,7 @@
 #define TILESETMGR_H
 
 #include "Plugin.h"
+#include "Sprite2D.h"
 #include "Tile.h"
 #include "System/DataStream.h"
 
@@ -30,8 +31,12 @@ namespace GemRB {
 class GEM_EXPORT TileSetMgr : public Plugin {
 public:
 	virtual bool Open(DataStream* stream) = 0;
+	/** the returned tile may defer decoding its frames until it is drawn,
+	 * in which case it keeps the tileset alive until then */
 	virtual Tile* GetTile(unsigned short* indexes, int count,
 		unsigned short* secondary = NULL) = 0;
+	/** decodes a single frame of the tileset */
+	virtual Holder<Sprite2D> GetTile(int index) = 0;
 };
 
 }
@@ -232,11 +232,8 @@ public:
 		}
 	}
 
-	void operator()(const Color& src, Color& dst, uint8_t mask) const override {
-		if (SRCALPHA && src.a == 0) {
-			return;
-		}
-		
+	// applies the mask and the "shader", everything but the blending itself
+	Color Shade(const Color& src, uint8_t mask) const {
 		Color c = src;
 		c.a = (mask) ? (255-mask) + (c.a * mask) : c.a; // FIXME: not sure this is 100% correct, but it passes my known tests
 
@@ -273,8 +270,15 @@ public:
 			default:
 				break;
 		}
+		return c;
+	}
+
+	void operator()(const Color& src, Color& dst, uint8_t mask) const override {
+		if (SRCALPHA && src.a == 0) {
+			return;
+		}
 
-		blender(c, dst);
+		blender(Shade(src, mask), dst);
 	}
 };
 
@@ -106,10 +106,22 @@ bool p2DAImporter::Open(DataStream* str)
 			row++;
 		}
 	}
+	IndexNames(colNames, colIndex);
+	IndexNames(rowNames, rowIndex);
 	delete str;
 	return true;
 }
 
+void p2DAImporter::IndexNames(const std::vector<char*>& names, NameIndex& index)
+{
+	index.clear();
+	index.reserve(names.size());
+	for (size_t i = 0; i < names.size(); i++) {
+		// emplace keeps the first one
+		index.emplace(names[i], int(i));
+	}
+}
+
 #include "plugindef.h"
 
 GEMRB_PLUGIN(0xB22F938, "2DA File Importer")
@@ -25,20 +25,48 @@
 
 #include "globals.h"
 
+#include <cctype>
 #include <cstring>
+#include <unordered_map>
 #include <vector>
 
 namespace GemRB {
 
 using RowEntry = std::vector<char*>;
 
+// case insensitive hashing of the names, which point into the table lines
+struct NameHash {
+	size_t operator()(const char* name) const
+	{
+		size_t h = 5381;
+		while (*name) {
+			h = (h << 5) + h + tolower(static_cast<unsigned char>(*name++));
+		}
+		return h;
+	}
+};
+
+struct NameEqual {
+	bool operator()(const char* lhs, const char* rhs) const
+	{
+		return stricmp(lhs, rhs) == 0;
+	}
+};
+
+using NameIndex = std::unordered_map<const char*, int, NameHash, NameEqual>;
+
 class p2DAImporter : public TableMgr {
 private:
 	std::vector< char*> colNames;
 	std::vector< char*> rowNames;
 	std::vector< char*> ptrs;
 	std::vector< RowEntry> rows;
+	// the first of any duplicates wins, like with a linear search
+	NameIndex colIndex;
+	NameIndex rowIndex;
 	char defVal[32];
+
+	static void IndexNames(const std::vector<char*>& names, NameIndex& index);
 public:
 	p2DAImporter(void);
 	~p2DAImporter(void) override;
@@ -101,22 +129,14 @@ public:
 
 	inline int GetRowIndex(const char* string) const override
 	{
-		for (unsigned int index = 0; index < rowNames.size(); index++) {
-			if (stricmp( rowNames[index], string ) == 0) {
-				return int(index);
-			}
-		}
-		return -1;
+		auto it = rowIndex.find(string);
+		return it == rowIndex.end() ? -1 : it->second;
 	}
 
 	inline int GetColumnIndex(const char* string) const override
 	{
-		for (unsigned int index = 0; index < colNames.size(); index++) {
-			if (stricmp( colNames[index], string ) == 0) {
-				return int(index);
-			}
-		}
-		return -1;
+		auto it = colIndex.find(string);
+		return it == colIndex.end() ? -1 : it->second;
 	}
 
 	inline const char* GetColumnName(unsigned int index) const override
@@ -26,12 +26,298 @@
 #include "PluginMgr.h"
 #include "System/SlicedStream.h"
 #include "System/FileStream.h"
+#include "System/MemoryStream.h"
+#include "System/ThreadPool.h"
 #if defined(SUPPORTS_MEMSTREAM)
 #include "System/MappedFileMemoryStream.h"
 #endif
 
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
 using namespace GemRB;
 
+// how much of the inflated BIFC blocks to keep around, for all archives together
+static const size_t MAX_INFLATED = 8 * 1024 * 1024;
+
+namespace {
+
+using InflatedBlock = std::shared_ptr<const std::vector<char>>;
+
+// the recently inflated blocks of every archive
+class InflatedCache {
+	using Key = std::pair<const void*, size_t>; // archive and block
+	struct KeyHash {
+		size_t operator()(const Key& key) const
+		{
+			return std::hash<const void*>()(key.first) ^ (key.second * 0x9E3779B9u);
+		}
+	};
+	using Recent = std::list<std::pair<Key, InflatedBlock>>;
+
+	// the most recently used blocks come first
+	Recent recent;
+	std::unordered_map<Key, Recent::iterator, KeyHash> index;
+	size_t inflatedSize = 0;
+	std::mutex lock;
+
+public:
+	InflatedBlock Find(const void* archive, size_t block)
+	{
+		std::lock_guard<std::mutex> l(lock);
+		auto it = index.find(Key(archive, block));
+		if (it == index.end()) {
+			return nullptr;
+		}
+		recent.splice(recent.begin(), recent, it->second);
+		return it->second->second;
+	}
+
+	void Add(const void* archive, size_t block, const InflatedBlock& data)
+	{
+		std::lock_guard<std::mutex> l(lock);
+		Key key(archive, block);
+		if (index.count(key)) {
+			return;
+		}
+		recent.emplace_front(key, data);
+		index[key] = recent.begin();
+		inflatedSize += data->size();
+		// blocks still being read stay alive through their readers
+		while (inflatedSize > MAX_INFLATED && recent.size() > 1) {
+			inflatedSize -= recent.back().second->size();
+			index.erase(recent.back().first);
+			recent.pop_back();
+		}
+	}
+
+	void Forget(const void* archive)
+	{
+		std::lock_guard<std::mutex> l(lock);
+		for (auto it = recent.begin(); it != recent.end();) {
+			if (it->first.first == archive) {
+				inflatedSize -= it->second->size();
+				index.erase(it->first);
+				it = recent.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+};
+
+// never destroyed, archives may still be closed during shutdown
+InflatedCache& Inflated()
+{
+	static InflatedCache* cache = new InflatedCache;
+	return *cache;
+}
+
+// collects what a Compressor writes
+class BlockWriter : public DataStream {
+	std::vector<char>& out;
+
+public:
+	explicit BlockWriter(std::vector<char>& out) : out(out) {}
+
+	int Read(void*, unsigned int) override { return GEM_ERROR; }
+	int Write(const void* src, unsigned int length) override
+	{
+		const char* bytes = static_cast<const char*>(src);
+		out.insert(out.end(), bytes, bytes + length);
+		return length;
+	}
+	int Seek(int, int) override { return GEM_ERROR; }
+};
+
+}
+
+BIFCStream::Blocks::~Blocks()
+{
+	Inflated().Forget(this);
+	delete archive;
+}
+
+BIFCStream::BIFCStream(const std::shared_ptr<Blocks>& shared, const char* path)
+	: shared(shared)
+{
+	const Block& last = shared->blocks.back();
+	size = last.start + last.declen;
+	ExtractFileFromPath(filename, path);
+	strlcpy(originalfile, path, _MAX_PATH);
+}
+
+BIFCStream* BIFCStream::Open(DataStream* archive)
+{
+	if (!core->IsAvailable(PLUGIN_COMPRESSION_ZLIB)) {
+		Log(ERROR, "BIFImporter", "No Compression Manager Available. Cannot Load Compressed File.");
+		delete archive;
+		return nullptr;
+	}
+
+	auto shared = std::make_shared<Blocks>();
+	shared->archive = archive;
+
+	// only the block headers are read here
+	ieDword unCompBifSize;
+	archive->ReadDword(unCompBifSize);
+	unsigned long start = 0;
+	while (start < unCompBifSize) {
+		Block block;
+		block.start = start;
+		if (archive->ReadDword(block.declen) == GEM_ERROR || archive->ReadDword(block.complen) == GEM_ERROR) {
+			break;
+		}
+		block.dataOffset = archive->GetPos();
+		if (!block.declen || archive->Seek(block.complen, GEM_CURRENT_POS) == GEM_ERROR) {
+			break;
+		}
+		shared->blocks.push_back(block);
+		start += block.declen;
+	}
+
+	if (start < unCompBifSize || shared->blocks.empty()) {
+		Log(ERROR, "BIFImporter", "Truncated BIFC archive: %s", archive->originalfile);
+		return nullptr;
+	}
+	return new BIFCStream(shared, archive->originalfile);
+}
+
+size_t BIFCStream::FindBlock(unsigned long pos) const
+{
+	const std::vector<Block>& blocks = shared->blocks;
+	auto it = std::upper_bound(blocks.begin(), blocks.end(), pos,
+		[](unsigned long p, const Block& block) { return p < block.start; });
+	return it - blocks.begin() - 1;
+}
+
+// call with the lock held
+bool BIFCStream::Inflate(size_t first, size_t last, std::vector<BlockData>& data)
+{
+	std::vector<size_t> missing;
+	data.resize(last - first + 1);
+	for (size_t i = first; i <= last; ++i) {
+		data[i - first] = Inflated().Find(shared.get(), i);
+		if (!data[i - first]) {
+			missing.push_back(i);
+		}
+	}
+	if (missing.empty()) {
+		return true;
+	}
+
+	// the archive is read in order, only the inflating runs in parallel
+	std::vector<DataStream*> compressed(missing.size());
+	std::vector<PluginHolder<Compressor>> comps(missing.size());
+	for (size_t j = 0; j < missing.size(); ++j) {
+		const Block& block = shared->blocks[missing[j]];
+		void* buffer = malloc(block.complen);
+		shared->archive->Seek(block.dataOffset, GEM_STREAM_START);
+		if (shared->archive->Read(buffer, block.complen) == GEM_ERROR) {
+			free(buffer);
+		} else {
+			compressed[j] = new MemoryStream(originalfile, buffer, block.complen);
+		}
+		comps[j] = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
+	}
+
+	std::vector<std::shared_ptr<std::vector<char>>> out(missing.size());
+	core->GetWorkerPool()->ParallelFor(missing.size(), [&](size_t j, unsigned int) {
+		if (!compressed[j]) return;
+		const Block& block = shared->blocks[missing[j]];
+		auto blockData = std::make_shared<std::vector<char>>();
+		blockData->reserve(block.declen);
+		BlockWriter writer(*blockData);
+		if (comps[j]->Decompress(&writer, compressed[j], block.complen) == GEM_OK && blockData->size() == block.declen) {
+			out[j] = blockData;
+		}
+		delete compressed[j];
+	});
+
+	for (size_t j = 0; j < missing.size(); ++j) {
+		if (!out[j]) {
+			Log(ERROR, "BIFImporter", "Cannot inflate block %zu of %s", missing[j], originalfile);
+			return false;
+		}
+		data[missing[j] - first] = out[j];
+		Inflated().Add(shared.get(), missing[j], out[j]);
+	}
+	return true;
+}
+
+int BIFCStream::Read(void* dest, unsigned int length)
+{
+	//we don't allow partial reads anyway, so it isn't a problem that
+	//i don't adjust length here (partial reads are evil)
+	if (Pos + length > size) {
+		return GEM_ERROR;
+	}
+	if (!length) {
+		return 0;
+	}
+
+	size_t first = FindBlock(Pos);
+	size_t last = FindBlock(Pos + length - 1);
+	std::vector<BlockData> data;
+	{
+		std::lock_guard<std::mutex> l(shared->lock);
+		if (!Inflate(first, last, data)) {
+			return GEM_ERROR;
+		}
+	}
+
+	char* out = static_cast<char*>(dest);
+	unsigned long pos = Pos;
+	unsigned long end = Pos + length;
+	for (size_t i = first; i <= last; ++i) {
+		const Block& block = shared->blocks[i];
+		unsigned long from = pos - block.start;
+		unsigned long count = std::min<unsigned long>(end, block.start + block.declen) - pos;
+		memcpy(out, data[i - first]->data() + from, count);
+		out += count;
+		pos += count;
+	}
+	Pos += length;
+	return length;
+}
+
+int BIFCStream::Write(const void*, unsigned int)
+{
+	return GEM_ERROR;
+}
+
+int BIFCStream::Seek(int newpos, int type)
+{
+	switch (type) {
+		case GEM_CURRENT_POS:
+			Pos += newpos;
+			break;
+
+		case GEM_STREAM_START:
+			Pos = newpos;
+			break;
+
+		case GEM_STREAM_END:
+			Pos = size - newpos;
+			break;
+
+		default:
+			return GEM_ERROR;
+	}
+	//we went past the buffer
+	if (Pos>size) {
+		print("[Streams]: Invalid seek position: %ld(limit: %ld)", Pos, size);
+		return GEM_ERROR;
+	}
+	return GEM_OK;
+}
+
+DataStream* BIFCStream::Clone()
+{
+	return new BIFCStream(shared, originalfile);
+}
+
 BIFImporter::BIFImporter(void)
 {
 	stream = NULL;
@@ -53,44 +339,6 @@ BIFImporter::~BIFImporter(void)
 	}
 }
 
-DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const char* path)
-{
-	print("Decompressing");
-	if (!core->IsAvailable( PLUGIN_COMPRESSION_ZLIB ))
-		return NULL;
-	PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
-	ieDword unCompBifSize;
-	compressed->ReadDword(unCompBifSize);
-#if !defined(SUPPORTS_MEMSTREAM)
-	fflush(stdout);
-#endif
-	FileStream out;
-	if (!out.Create(path)) {
-		Log(ERROR, "BIFImporter", "Cannot write %s.", path);
-		return NULL;
-	}
-	size_t finalsize = 0;
-	int laststep = 0;
-	while (finalsize < unCompBifSize) {
-		ieDword complen, declen;
-		compressed->ReadDword(declen);
-		compressed->ReadDword(complen);
-		if (comp->Decompress( &out, compressed, complen ) != GEM_OK) {
-			return NULL;
-		}
-		finalsize = out.GetPos();
-		if (( int ) ( finalsize * ( 10.0 / unCompBifSize ) ) != laststep) {
-			laststep++;
-		}
-	}
-	out.Close(); // This is necesary, since windows won't open the file otherwise.
-#if defined(SUPPORTS_MEMSTREAM)
-	return new MappedFileMemoryStream{path};
-#else
-	return FileStream::OpenFile(path);
-#endif
-}
-
 DataStream* BIFImporter::DecompressBIF(DataStream* compressed, const char* /*path*/)
 {
 	ieDword fnlen, complen, declen;
@@ -142,8 +390,7 @@ int BIFImporter::OpenArchive(const char* path)
 			stream = DecompressBIF(file, cachePath);
 			delete file;
 		} else if (strncmp(Signature, "BIFCV1.0", 8) == 0) {
-			stream = DecompressBIFC(file, cachePath);
-			delete file;
+			stream = BIFCStream::Open(file);
 		} else if (strncmp( Signature, "BIFFV1  ", 8 ) == 0) {
 			file->Seek(0, GEM_STREAM_START);
 			stream = file;
@@ -173,25 +420,48 @@ int BIFImporter::OpenArchive(const char* path)
 DataStream* BIFImporter::GetStream(unsigned long Resource, unsigned long Type)
 {
 	if (Type == IE_TIS_CLASS_ID) {
-		unsigned int srcResLoc = Resource & 0xFC000;
-		for (unsigned int i = 0; i < tentcount; i++) {
-			if (( tentries[i].resLocator & 0xFC000 ) == srcResLoc) {
-				return SliceStream( stream, tentries[i].dataOffset,
-							tentries[i].tileSize * tentries[i].tilesCount );
-			}
+		size_t idx = (Resource & 0xFC000) >> 14;
+		if (idx < tileIndex.size() && tileIndex[idx] >= 0) {
+			const TileEntry &entry = tentries[tileIndex[idx]];
+			return SliceStream( stream, entry.dataOffset,
+						entry.tileSize * entry.tilesCount );
 		}
 	} else {
-		ieDword srcResLoc = Resource & 0x3FFF;
-		for (ieDword i = 0; i < fentcount; i++) {
-			if (( fentries[i].resLocator & 0x3FFF ) == srcResLoc) {
-				return SliceStream( stream, fentries[i].dataOffset,
-							fentries[i].fileSize );
-			}
+		size_t idx = Resource & 0x3FFF;
+		if (idx < fileIndex.size() && fileIndex[idx] >= 0) {
+			const FileEntry &entry = fentries[fileIndex[idx]];
+			return SliceStream( stream, entry.dataOffset, entry.fileSize );
 		}
 	}
 	return NULL;
 }
 
+// the locators are (nearly) contiguous, so plain arrays do
+void BIFImporter::IndexEntries()
+{
+	fileIndex.clear();
+	tileIndex.clear();
+	for (ieDword i = 0; i < fentcount; i++) {
+		size_t idx = fentries[i].resLocator & 0x3FFF;
+		if (idx >= fileIndex.size()) {
+			fileIndex.resize(idx + 1, -1);
+		}
+		// the first one wins, like with the old linear search
+		if (fileIndex[idx] < 0) {
+			fileIndex[idx] = i;
+		}
+	}
+	for (ieDword i = 0; i < tentcount; i++) {
+		size_t idx = (tentries[i].resLocator & 0xFC000) >> 14;
+		if (idx >= tileIndex.size()) {
+			tileIndex.resize(idx + 1, -1);
+		}
+		if (tileIndex[idx] < 0) {
+			tileIndex[idx] = i;
+		}
+	}
+}
+
 void BIFImporter::ReadBIF(void)
 {
 	ieDword foffset;
@@ -228,6 +498,7 @@ void BIFImporter::ReadBIF(void)
 		stream->ReadWord(tentries[i].type);
 		stream->ReadWord(tentries[i].u1);
 	}
+	IndexEntries();
 }
 
 #include "plugindef.h"
@@ -27,6 +27,10 @@
 
 #include "System/DataStream.h"
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace GemRB {
 
 struct FileEntry {
@@ -46,11 +50,49 @@ struct TileEntry {
 	ieWord  u1; //Unknown Field
 };
 
+// Reads a BIFC archive straight from its compressed blocks, inflating only
+// the ones a read touches. Clones share the blocks, and what was inflated
+// stays in a cache shared by all archives.
+class BIFCStream : public DataStream {
+private:
+	struct Block {
+		unsigned long start; // in the uncompressed bif
+		ieDword declen;
+		unsigned long dataOffset; // of the compressed data in the archive
+		ieDword complen;
+	};
+	using BlockData = std::shared_ptr<const std::vector<char>>;
+
+	struct Blocks {
+		DataStream* archive = nullptr;
+		std::vector<Block> blocks;
+		std::mutex lock;
+
+		~Blocks();
+	};
+	std::shared_ptr<Blocks> shared;
+
+	BIFCStream(const std::shared_ptr<Blocks>& shared, const char* path);
+	size_t FindBlock(unsigned long pos) const;
+	bool Inflate(size_t first, size_t last, std::vector<BlockData>& data);
+
+public:
+	// takes the archive, positioned right after the signature
+	static BIFCStream* Open(DataStream* archive);
+
+	int Read(void* dest, unsigned int length) override;
+	int Write(const void* src, unsigned int length) override;
+	int Seek(int pos, int startpos) override;
+	DataStream* Clone() override;
+};
+
 class BIFImporter : public IndexedArchive {
 private:
 	FileEntry* fentries;
 	TileEntry* tentries;
 	ieDword fentcount, tentcount;
+	// entry positions by the locator index, -1 for gaps
+	std::vector<int> fileIndex, tileIndex;
 	DataStream* stream;
 public:
 	BIFImporter(void);
@@ -59,8 +101,8 @@ public:
 	DataStream* GetStream(unsigned long Resource, unsigned long Type) override;
 private:
 	static DataStream* DecompressBIF(DataStream* compressed, const char* path);
-	static DataStream* DecompressBIFC(DataStream* compressed, const char* path);
 	void ReadBIF(void);
+	void IndexEntries();
 };
 
 }
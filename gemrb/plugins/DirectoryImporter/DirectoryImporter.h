@@ -51,6 +51,7 @@ public:
 	CachedDirectoryImporter() = default;
 	bool Open(const char *dir, const char *desc) override;
 	void Refresh();
+	bool IsStable() const override { return true; }
 	/** predicts the availability of a resource */
 	bool HasResource(const char* resname, SClass_ID type) override;
 	bool HasResource(const char* resname, const ResourceDesc &type) override;
@@ -29,6 +29,9 @@
 
 using namespace GemRB;
 
+// area loads touch many resources in the same few bifs
+static const size_t OPEN_ARCHIVES = 8;
+
 KEYImporter::KEYImporter(void)
 {
 	description = NULL;
@@ -205,6 +208,30 @@ bool KEYImporter::HasResource(const char* resname, const ResourceDesc &type)
 	return HasResource(resname, type.GetKeyType());
 }
 
+PluginHolder<IndexedArchive> KEYImporter::GetArchive(unsigned int bifnum)
+{
+	for (auto it = openArchives.begin(); it != openArchives.end(); ++it) {
+		if (it->bifnum == bifnum) {
+			openArchives.splice(openArchives.begin(), openArchives, it);
+			return it->plugin;
+		}
+	}
+
+	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
+	if (ai->OpenArchive( biffiles[bifnum].path ) == GEM_ERROR) {
+		print("Cannot open archive %s", biffiles[bifnum].path);
+		return nullptr;
+	}
+
+	openArchives.emplace_front();
+	openArchives.front().bifnum = bifnum;
+	openArchives.front().plugin = ai;
+	if (openArchives.size() > OPEN_ARCHIVES) {
+		openArchives.pop_back();
+	}
+	return ai;
+}
+
 DataStream* KEYImporter::GetStream(const char *resname, ieWord type)
 {
 	if (type == 0)
@@ -222,9 +249,10 @@ DataStream* KEYImporter::GetStream(const char *resname, ieWord type)
 		return NULL;
 	}
 
-	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
-	if (ai->OpenArchive( biffiles[bifnum].path ) == GEM_ERROR) {
-		print("Cannot open archive %s", biffiles[bifnum].path);
+	// archives share their stream with all readers
+	std::lock_guard<std::mutex> l(archiveLock);
+	PluginHolder<IndexedArchive> ai = GetArchive(bifnum);
+	if (!ai) {
 		return NULL;
 	}
 
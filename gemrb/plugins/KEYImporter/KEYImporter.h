@@ -28,6 +28,8 @@
 
 #include "StringMap.h"
 
+#include <list>
+#include <mutex>
 #include <vector>
 
 namespace GemRB {
@@ -130,6 +132,12 @@ class KEYImporter : public ResourceSource {
 private:
 	std::vector< BIFEntry> biffiles;
 	KEYImpMap resources;
+	// the most recently used archives come first
+	std::list<KEYCache> openArchives;
+	std::mutex archiveLock;
+
+	/** Gets the open archive of a bif, opening it if needed */
+	PluginHolder<IndexedArchive> GetArchive(unsigned int bifnum);
 
 	/** Gets the stream assoicated to a RESKey */
 	DataStream *GetStream(const char *resname, ieWord type);
@@ -137,6 +145,7 @@ public:
 	KEYImporter(void);
 	~KEYImporter(void) override;
 	bool Open(const char *file, const char *desc) override;
+	bool IsStable() const override { return true; }
 	/* predicts the availability of a resource */
 	bool HasResource(const char* resname, SClass_ID type) override;
 	bool HasResource(const char* resname, const ResourceDesc &type) override;
@@ -30,6 +30,7 @@ public:
 	NullSource(void);
 	~NullSource(void) override;
 	bool Open(const char *filename, const char *description) override;
+	bool IsStable() const override { return true; }
 	bool HasResource(const char* resname, SClass_ID type) override;
 	bool HasResource(const char* resname, const ResourceDesc &type) override;
 	DataStream* GetResource(const char* resname, SClass_ID type) override;
@@ -22,9 +22,42 @@
 #include "FileCache.h"
 #include "Interface.h"
 #include "PluginMgr.h"
+#include "System/FileStream.h"
+#include "System/ThreadPool.h"
+#include "System/VFS.h"
 
 using namespace GemRB;
 
+namespace {
+
+// collects the output of the compressor, so entries can be packed side by side
+class PackedEntry : public DataStream {
+public:
+	char name[_MAX_PATH]{};
+	ieDword declen = 0;
+	std::vector<char> data;
+	int result = GEM_ERROR;
+
+	int Read(void*, unsigned int) override { return GEM_ERROR; }
+	int Write(const void* src, unsigned int len) override
+	{
+		const char* bytes = static_cast<const char*>(src);
+		data.insert(data.end(), bytes, bytes + len);
+		size = Pos = data.size();
+		return len;
+	}
+	int Seek(int, int) override { return GEM_ERROR; }
+};
+
+}
+
+// the tlk override is modified in place, so it has to be a file in the cache
+static bool InPlaceEntry(const char *fname)
+{
+	const char *ext = strrchr(fname, '.');
+	return ext && (!strcmp(ext, ".tot") || !strcmp(ext, ".toh"));
+}
+
 int SAVImporter::DecompressSaveGame(DataStream *compressed, SaveGameAREExtractor& areExtractor)
 {
 	char Signature[8];
@@ -52,17 +85,24 @@ int SAVImporter::DecompressSaveGame(DataStream *compressed, SaveGameAREExtractor
 		compressed->ReadDword(declen);
 		compressed->ReadDword(complen);
 
-		auto areExt = strstr(fname, ".are");
-		if (areExt != nullptr && fname + fnlen - 5 == areExt) {
-			areExtractor.registerLocation(fname, position);
-			compressed->Seek(complen, GEM_CURRENT_POS);
-		} else {
+		if (InPlaceEntry(fname)) {
 			Log(MESSAGE, "SAVImporter", "Decompressing %s", fname);
 			DataStream* cached = CacheCompressedStream(compressed, fname, complen, true);
-			free( fname );
+			free(fname);
 			if (!cached)
 				return GEM_ERROR;
 			delete cached;
+		} else {
+			// the rest is decompressed only when requested
+			areExtractor.registerLocation(fname, position);
+			if (core->config.KeepCache) {
+				// a stale copy would shadow the one in the save
+				char path[_MAX_PATH];
+				PathJoin(path, core->config.CachePath, fname, nullptr);
+				unlink(path);
+			}
+			free(fname);
+			compressed->Seek(complen, GEM_CURRENT_POS);
 		}
 
 		Current = compressed->Remains();
@@ -76,7 +116,7 @@ int SAVImporter::DecompressSaveGame(DataStream *compressed, SaveGameAREExtractor
 	while(Current);
 
 	tick_t endTime = GetTicks();
-	Log(WARNING, "Core", "%lu ms (extracting the SAV)", endTime - startTime);
+	Log(WARNING, "Core", "%lu ms (indexing the SAV)", endTime - startTime);
 	return GEM_OK;
 }
 
@@ -121,6 +161,43 @@ int SAVImporter::AddToSaveGame(DataStream *str, DataStream *uncompressed)
 	return GEM_OK;
 }
 
+int SAVImporter::AddFilesToSaveGame(DataStream *str, const std::vector<std::string>& paths, int level)
+{
+	PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
+	std::vector<PackedEntry> entries(paths.size());
+
+	// the files are independent, only appending them has to happen in order
+	core->GetWorkerPool()->ParallelFor(paths.size(), [&](size_t i, unsigned int) {
+		PackedEntry& entry = entries[i];
+		FileStream fs;
+		if (!fs.Open(paths[i].c_str())) {
+			return;
+		}
+		strlcpy(entry.name, fs.filename, sizeof(entry.name));
+		entry.declen = fs.Size();
+		entry.result = comp->Compress(&entry, &fs, level);
+	});
+
+	int ret = GEM_OK;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const PackedEntry& entry = entries[i];
+		if (entry.result != GEM_OK) {
+			Log(ERROR, "SAVImporter", "Failed to compress \"%s\".", paths[i].c_str());
+			ret = GEM_ERROR;
+			continue;
+		}
+
+		ieDword fnlen = strlen(entry.name) + 1;
+		ieDword complen = entry.data.size();
+		str->WriteDword(fnlen);
+		str->Write(entry.name, fnlen);
+		str->WriteDword(entry.declen);
+		str->WriteDword(complen);
+		str->Write(entry.data.data(), complen);
+	}
+	return ret;
+}
+
 int SAVImporter::AddToSaveGameCompressed(DataStream *str, DataStream *compressed) {
 	using BufferT = std::array<uint8_t, 4096>;
 	BufferT buffer{};
@@ -34,6 +34,7 @@ public:
 	SAVImporter() = default;
 	int DecompressSaveGame(DataStream *compressed, SaveGameAREExtractor&) override;
 	int AddToSaveGame(DataStream *str, DataStream *uncompressed) override;
+	int AddFilesToSaveGame(DataStream *str, const std::vector<std::string>& paths, int level) override;
 	int AddToSaveGameCompressed(DataStream *str, DataStream *compressed) override;
 	int CreateArchive(DataStream *compressed) override;
 };
@@ -125,7 +125,24 @@ VideoBuffer* SDL12VideoDriver::NewVideoBuffer(const Region& r, BufferFormat fmt)
 	}
 }
 
-IAlphaIterator* SDL12VideoDriver::StencilIterator(BlitFlags flags, const Region& maskclip) const
+static void StencilChannel(BlitFlags flags, const SDL_PixelFormat* fmt, Uint32& mask, Uint8& shift)
+{
+	if (flags&BlitFlags::STENCIL_RED) {
+		mask = fmt->Rmask;
+		shift = fmt->Rshift;
+	} else if (flags&BlitFlags::STENCIL_GREEN) {
+		mask = fmt->Gmask;
+		shift = fmt->Gshift;
+	} else if (flags&BlitFlags::STENCIL_BLUE) {
+		mask = fmt->Bmask;
+		shift = fmt->Bshift;
+	} else {
+		mask = fmt->Amask;
+		shift = fmt->Ashift;
+	}
+}
+
+IAlphaIterator* SDL12VideoDriver::StencilIterator(BlitFlags flags, const Region& dst) const
 {
 	struct SurfaceAlphaIterator : RGBAChannelIterator {
 		SDLPixelIteratorWrapper wrap;
@@ -137,27 +154,14 @@ IAlphaIterator* SDL12VideoDriver::StencilIterator(BlitFlags flags, const Region&
 
 	if (flags&BLIT_STENCIL_MASK) {
 		SDL_Surface* maskSurf = CurrentStencilBuffer();
-		SDL_PixelFormat* fmt = maskSurf->format;
 
 		Uint32 mask = 0;
 		Uint8 shift = 0;
-		if (flags&BlitFlags::STENCIL_RED) {
-			mask = fmt->Rmask;
-			shift = fmt->Rshift;
-		} else if (flags&BlitFlags::STENCIL_GREEN) {
-			mask = fmt->Gmask;
-			shift = fmt->Gshift;
-		} else if (flags&BlitFlags::STENCIL_BLUE) {
-			mask = fmt->Bmask;
-			shift = fmt->Bshift;
-		} else {
-			mask = fmt->Amask;
-			shift = fmt->Ashift;
-		}
+		StencilChannel(flags, maskSurf->format, mask, shift);
 		
-		const Point& stencilOrigin = stencilBuffer->Origin();
-		maskclip.x -= stencilOrigin.x;
-		maskclip.y -= stencilOrigin.y;
+		// Region's members are references, so this has to be a copy to leave dst alone
+		Region maskclip = dst;
+		maskclip.origin -= stencilBuffer->Origin();
 		IPixelIterator::Direction xdir = (flags&BlitFlags::MIRRORX) ? IPixelIterator::Reverse : IPixelIterator::Forward;
 		IPixelIterator::Direction ydir = (flags&BlitFlags::MIRRORY) ? IPixelIterator::Reverse : IPixelIterator::Forward;
 		maskit = new SurfaceAlphaIterator(maskSurf, maskclip, mask, shift, xdir, ydir);
@@ -166,6 +170,24 @@ IAlphaIterator* SDL12VideoDriver::StencilIterator(BlitFlags flags, const Region&
 	return maskit;
 }
 
+BlitPlane SDL12VideoDriver::StencilPlane(BlitFlags flags, const Region& dst, Uint32& mask, Uint8& shift) const
+{
+	if (!(flags & BLIT_STENCIL_MASK)) {
+		return BlitPlane();
+	}
+
+	SDL_Surface* maskSurf = CurrentStencilBuffer();
+	// stencils are DISPLAY_ALPHA buffers, which SDL always makes 32 bit
+	assert(maskSurf->format->BytesPerPixel == 4);
+	StencilChannel(flags, maskSurf->format, mask, shift);
+
+	Region maskclip = dst;
+	maskclip.origin -= stencilBuffer->Origin();
+	bool mirrorX = flags & BlitFlags::MIRRORX;
+	bool mirrorY = flags & BlitFlags::MIRRORY;
+	return BlitPlane(maskSurf->pixels, maskSurf->pitch, 4, maskclip, mirrorX, mirrorY);
+}
+
 void SDL12VideoDriver::BlitSpriteRLEClipped(const Holder<Sprite2D>& spr, const Region& src, const Region& dst,
 											BlitFlags flags, const Color* t)
 {
@@ -196,7 +218,9 @@ void SDL12VideoDriver::BlitSpriteRLEClipped(const Holder<Sprite2D>& spr, const R
 	PaletteHolder palette = spr->GetPalette();
 	SDL_Surface* currentBuf = CurrentRenderBuffer();
 
-	IAlphaIterator* maskit = StencilIterator(flags, dst);
+	Uint32 stencilMask = 0;
+	Uint8 stencilShift = 0;
+	BlitPlane stencil = StencilPlane(flags, dst, stencilMask, stencilShift);
 
 	// remove already handled flags and incompatible combinations
 	unsigned int remflags = flags & ~(BlitFlags::BLENDED | BlitFlags::MIRRORX | BlitFlags::MIRRORY | BLIT_STENCIL_MASK);
@@ -206,13 +230,13 @@ void SDL12VideoDriver::BlitSpriteRLEClipped(const Holder<Sprite2D>& spr, const R
 
 	if (remflags == BlitFlags::COLOR_MOD && tint.a == 255) {
 		SRTinter_Tint<true, true> tinter(tint);
-		BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+		BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 	} else if (remflags == BlitFlags::HALFTRANS) {
 		SRTinter_NoTint<false> tinter;
-		BlitSpriteRLE<SRBlender_HalfAlpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+		BlitSpriteRLE<SRBlender_HalfAlpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 	} else if (remflags == 0 && palette->HasAlpha() == false) {
 		SRTinter_NoTint<false> tinter;
-		BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+		BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 	} else {
 		// handling the following effects with conditionals:
 		// halftrans
@@ -233,23 +257,21 @@ void SDL12VideoDriver::BlitSpriteRLEClipped(const Holder<Sprite2D>& spr, const R
 		if (palette->HasAlpha()) {
 			if (remflags & BlitFlags::COLOR_MOD) {
 				SRTinter_Flags<true> tinter(tint);
-				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 			} else {
 				SRTinter_FlagsNoTint<true> tinter;
-				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 			}
 		} else {
 			if (remflags & BlitFlags::COLOR_MOD) {
 				SRTinter_Flags<false> tinter(tint);
-				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 			} else {
 				SRTinter_FlagsNoTint<false> tinter;
-				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, maskit, flags, tinter);
+				BlitSpriteRLE<SRBlender_Alpha>(spr, src, currentBuf, dst, stencil, stencilMask, stencilShift, flags, tinter);
 			}
 		}
 	}
-
-	delete maskit;
 }
 
 void SDL12VideoDriver::BlitSpriteNativeClipped(const sprite_t* spr, const Region& srect, const Region& drect, BlitFlags flags, const SDL_Color* tint)
@@ -296,17 +318,16 @@ void SDL12VideoDriver::BlitSpriteNativeClipped(const sprite_t* spr, const Region
 	// remove already handled flags and incompatible combinations
 	if (flags & BlitFlags::GREY) flags &= ~BlitFlags::SEPIA;
 
-	IAlphaIterator* maskIt = StencilIterator(flags, drect);
-	
 	SDL_Surface* surf = spr->GetSurface();
 	bool nativeBlit = (flags & ~(BlitFlags::HALFTRANS | BlitFlags::ALPHA_MOD | BlitFlags::BLENDED)) == 0
-						&& maskIt == nullptr && ((surf->flags & SDL_SRCCOLORKEY) != 0
+						&& !(flags & BLIT_STENCIL_MASK) && ((surf->flags & SDL_SRCCOLORKEY) != 0
 						|| (flags & BlitFlags::BLENDED) == 0);
 	if (nativeBlit) {
 		SDL_Rect s = RectFromRegion(srect);
 		SDL_Rect d = RectFromRegion(drect);
 		BlitSpriteNativeClipped(surf, &s, &d, flags, tint);
-	} else {		
+	} else if (!BlitWithKernel(surf, srect, drect, flags, tint)) {
+		IAlphaIterator* maskIt = StencilIterator(flags, drect);
 		SDLPixelIterator::Direction xdir = (flags&BlitFlags::MIRRORX) ? SDLPixelIterator::Reverse : SDLPixelIterator::Forward;
 		SDLPixelIterator::Direction ydir = (flags&BlitFlags::MIRRORY) ? SDLPixelIterator::Reverse : SDLPixelIterator::Forward;
 
@@ -314,9 +335,8 @@ void SDL12VideoDriver::BlitSpriteNativeClipped(const sprite_t* spr, const Region
 		auto dst = MakeSDLPixelIterator(CurrentRenderBuffer(), SDLPixelIterator::Forward, SDLPixelIterator::Forward, drect);
 		
 		BlitWithPipeline(src, dst, maskIt, flags, tint);
+		delete maskIt;
 	}
-	
-	delete maskIt;
 }
 
 void SDL12VideoDriver::BlitSpriteNativeClipped(SDL_Surface* surf, SDL_Rect* src, SDL_Rect* dst, BlitFlags flags, Color tint)
@@ -347,7 +367,51 @@ void SDL12VideoDriver::BlitSpriteNativeClipped(SDL_Surface* surf, SDL_Rect* src,
 	SDL_LowerBlit(surf, src, CurrentRenderBuffer(), dst);
 }
 
-void SDL12VideoDriver::BlitWithPipeline(SDLPixelIterator& src, SDLPixelIterator& dst, IAlphaIterator* maskIt, BlitFlags flags, Color tint)
+// the generic blit, going through the pixel iterators
+struct IteratorBlit {
+	SDLPixelIterator& src;
+	SDLPixelIterator& dst;
+	IAlphaIterator* maskIt;
+
+	template <void (*BLEND)(const Color& src, Color& dst), typename PIPELINE>
+	void Run(const PIPELINE& pipeline) const {
+		BlitBlendedRect(src, dst, pipeline, maskIt);
+	}
+};
+
+// the same for the formats the row kernels can handle
+struct KernelBlit {
+	const BlitKernelArgs& args;
+
+	template <void (*BLEND)(const Color& src, Color& dst), typename PIPELINE>
+	void Run(const PIPELINE& pipeline) const {
+		BlitKernel<PIPELINE, BLEND>(args, pipeline);
+	}
+};
+
+template <void (*BLEND)(const Color& src, Color& dst), typename BLITTER>
+static void BlitShaded(const BLITTER& blit, BlitFlags flags, const Color& tint)
+{
+	if (flags & (BlitFlags::COLOR_MOD | BlitFlags::ALPHA_MOD)) {
+		if (flags&BlitFlags::GREY) {
+			blit.template Run<BLEND>(RGBBlendingPipeline<SHADER::GREYSCALE, true>(tint, BLEND));
+		} else if (flags&BlitFlags::SEPIA) {
+			blit.template Run<BLEND>(RGBBlendingPipeline<SHADER::SEPIA, true>(tint, BLEND));
+		} else {
+			blit.template Run<BLEND>(RGBBlendingPipeline<SHADER::TINT, true>(tint, BLEND));
+		}
+	} else if (flags&BlitFlags::GREY) {
+		blit.template Run<BLEND>(RGBBlendingPipeline<SHADER::GREYSCALE, true>(BLEND));
+	} else if (flags&BlitFlags::SEPIA) {
+		blit.template Run<BLEND>(RGBBlendingPipeline<SHADER::SEPIA, true>(BLEND));
+	} else {
+		blit.template Run<BLEND>(RGBBlendingPipeline<SHADER::NONE, true>(BLEND));
+	}
+}
+
+// picks the blending once per blit, so the blitters can inline it
+template <typename BLITTER>
+static void BlitWithPipeline(const BLITTER& blit, BlitFlags flags, Color tint)
 {
 	bool halftrans = flags & BlitFlags::HALFTRANS;
 	if (halftrans && (flags ^ BlitFlags::HALFTRANS)) { // other flags are set too
@@ -364,34 +428,43 @@ void SDL12VideoDriver::BlitWithPipeline(SDLPixelIterator& src, SDLPixelIterator&
 	// we don't currently have a need for non blended sprites (we do for primitives, which is handled elsewhere)
 	// however, it could make things faster if we handled it
 	
-	void (*BlendFn)(const Color& src, Color& dst) = ShaderBlend<true>;
 	if (flags & BlitFlags::ADD) {
-		BlendFn = ShaderAdditive;
+		BlitShaded<ShaderAdditive>(blit, flags, tint);
 	} else if (flags & BlitFlags::MULTIPLY) {
-		BlendFn = ShaderTint;
-	}
-	
-	if (flags & (BlitFlags::COLOR_MOD | BlitFlags::ALPHA_MOD)) {
-		if (flags&BlitFlags::GREY) {
-			RGBBlendingPipeline<SHADER::GREYSCALE, true> blender(tint, BlendFn);
-			BlitBlendedRect(src, dst, blender, maskIt);
-		} else if (flags&BlitFlags::SEPIA) {
-			RGBBlendingPipeline<SHADER::SEPIA, true> blender(tint, BlendFn);
-			BlitBlendedRect(src, dst, blender, maskIt);
-		} else {
-			RGBBlendingPipeline<SHADER::TINT, true> blender(tint, BlendFn);
-			BlitBlendedRect(src, dst, blender, maskIt);
-		}
-	} else if (flags&BlitFlags::GREY) {
-		RGBBlendingPipeline<SHADER::GREYSCALE, true> blender(BlendFn);
-		BlitBlendedRect(src, dst, blender, maskIt);
-	} else if (flags&BlitFlags::SEPIA) {
-		RGBBlendingPipeline<SHADER::SEPIA, true> blender(BlendFn);
-		BlitBlendedRect(src, dst, blender, maskIt);
+		BlitShaded<ShaderTint>(blit, flags, tint);
 	} else {
-		RGBBlendingPipeline<SHADER::NONE, true> blender(BlendFn);
-		BlitBlendedRect(src, dst, blender, maskIt);
+		BlitShaded<ShaderBlend<true>>(blit, flags, tint);
+	}
+}
+
+void SDL12VideoDriver::BlitWithPipeline(SDLPixelIterator& src, SDLPixelIterator& dst, IAlphaIterator* maskIt, BlitFlags flags, Color tint)
+{
+	::BlitWithPipeline(IteratorBlit { src, dst, maskIt }, flags, tint);
+}
+
+bool SDL12VideoDriver::BlitWithKernel(SDL_Surface* surf, const Region& srect, const Region& drect, BlitFlags flags, Color tint)
+{
+	SDL_Surface* target = CurrentRenderBuffer();
+	PixelFormat srcFormat = PixelFormatForSurface(surf);
+	PixelFormat dstFormat = PixelFormatForSurface(target);
+	if (!BlitKernelSupports(srcFormat, false) || !BlitKernelSupports(dstFormat, true)) {
+		return false;
 	}
+
+	bool mirrorX = flags & BlitFlags::MIRRORX;
+	bool mirrorY = flags & BlitFlags::MIRRORY;
+	BlitKernelArgs args;
+	args.size = drect.size;
+	args.src = BlitPlane(surf->pixels, surf->pitch, srcFormat.Bpp, srect, mirrorX, mirrorY);
+	args.dst = BlitPlane(target->pixels, target->pitch, dstFormat.Bpp, drect, false, false);
+	args.srcFormat = &srcFormat;
+	args.dstFormat = &dstFormat;
+
+	// like StencilIterator, the stencil is walked in the directions of the source
+	args.stencil = StencilPlane(flags, drect, args.stencilMask, args.stencilShift);
+
+	::BlitWithPipeline(KernelBlit { args }, flags, tint);
+	return true;
 }
 
 void SDL12VideoDriver::BlitVideoBuffer(const VideoBufferPtr& buf, const Point& p, BlitFlags flags, Color tint)
@@ -399,17 +472,31 @@ void SDL12VideoDriver::BlitVideoBuffer(const VideoBufferPtr& buf, const Point& p
 	auto surface = static_cast<SDLSurfaceVideoBuffer&>(*buf).Surface();
 	const Region& r = buf->Rect();
 	Point origin = r.origin + p;
-	
+
+	// neither path clips on its own, so apply the screen clip here
+	Region drect = ClippedDrawingRect(Region(origin, r.size));
+	if (drect.w <= 0 || drect.h <= 0) {
+		return;
+	}
+	Region srect(Point(drect.x - origin.x, drect.y - origin.y), drect.size);
+	if (flags & BlitFlags::MIRRORX) {
+		srect.x = r.w - srect.x - srect.w;
+	}
+	if (flags & BlitFlags::MIRRORY) {
+		srect.y = r.h - srect.y - srect.h;
+	}
+
 	bool nativeBlit = (flags & ~(BlitFlags::HALFTRANS | BlitFlags::ALPHA_MOD | BlitFlags::BLENDED)) == 0
 						&& ((surface->flags & SDL_SRCCOLORKEY) != 0 || (flags & BlitFlags::BLENDED) == 0);
 
 	if (nativeBlit) {
-		SDL_Rect srect = {0, 0, Uint16(r.w), Uint16(r.h)};
-		SDL_Rect drect = {Sint16(origin.x), Sint16(origin.y), Uint16(r.w), Uint16(r.h)};
-		BlitSpriteNativeClipped(surface, &srect, &drect, flags, tint);
+		SDL_Rect sdlsrect = RectFromRegion(srect);
+		SDL_Rect sdldrect = RectFromRegion(drect);
+		BlitSpriteNativeClipped(surface, &sdlsrect, &sdldrect, flags, tint);
 	} else {
-		const Region& srect = {Point(), r.size};
-		const Region& drect = {origin, r.size};
+		if (BlitWithKernel(surface, srect, drect, flags, tint)) {
+			return;
+		}
 
 		SDLPixelIterator::Direction xdir = (flags&BlitFlags::MIRRORX) ? SDLPixelIterator::Reverse : SDLPixelIterator::Forward;
 		SDLPixelIterator::Direction ydir = (flags&BlitFlags::MIRRORY) ? SDLPixelIterator::Reverse : SDLPixelIterator::Forward;
@@ -496,12 +583,17 @@ void SDL12VideoDriver::DrawRectImp(const Region& rgn, const Color& color, bool f
 		if (flags&BlitFlags::BLENDED && color.a < 0xff) {
 			assert(rgn.w > 0 && rgn.h > 0);
 			
-			const static OneMinusSrcA<false, false> blender;
-			
 			Region clippedrgn = ClippedDrawingRect(rgn);
 			auto dstit = MakeSDLPixelIterator(currentBuf, clippedrgn);
 			auto dstend = SDLPixelIterator::end(dstit);
-			ColorFill(color, dstit, dstend, blender);
+			if (currentBuf->format->Amask) {
+				// buffers with alpha (like the fog) are composited later, so they need the coverage too
+				const static OneMinusSrcA<false, true> blender;
+				ColorFill(color, dstit, dstend, blender);
+			} else {
+				const static OneMinusSrcA<false, false> blender;
+				ColorFill(color, dstit, dstend, blender);
+			}
 		} else {
 			Uint32 val = SDL_MapRGBA( currentBuf->format, color.r, color.g, color.b, color.a );
 			SDL_Rect drect = RectFromRegion(ClippedDrawingRect(rgn));
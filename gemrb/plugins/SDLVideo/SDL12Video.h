@@ -21,6 +21,7 @@
 #ifndef SDL12VIDEODRIVER_H
 #define SDL12VIDEODRIVER_H
 
+#include "SDLBlitKernels.h"
 #include "SDLVideo.h"
 
 namespace GemRB {
@@ -67,6 +68,8 @@ private:
 	SDLVideoDriver::vid_buf_t* CurrentStencilBuffer() const override;
 	
 	IAlphaIterator* StencilIterator(BlitFlags flags, const Region& dst) const;
+	// the same for the row based blitters, without pixels if there is no stencil
+	BlitPlane StencilPlane(BlitFlags flags, const Region& dst, Uint32& mask, Uint8& shift) const;
 
 	int ProcessEvent(const SDL_Event & event) override;
 
@@ -78,6 +81,8 @@ private:
 	void BlitSpriteNativeClipped(const sprite_t* spr, const Region& src, const Region& dst, BlitFlags flags, Color tint);
 	void BlitSpriteNativeClipped(SDL_Surface* surf, SDL_Rect* src, SDL_Rect* dst, BlitFlags flags, Color tint);
 	void BlitWithPipeline(SDLPixelIterator& src, SDLPixelIterator& dst, IAlphaIterator* maskit, BlitFlags flags, Color tint);
+	// the same as BlitWithPipeline for the common formats, returns false for the others
+	bool BlitWithKernel(SDL_Surface* surf, const Region& src, const Region& dst, BlitFlags flags, Color tint);
 
 	void DrawSDLPoints(const std::vector<SDL_Point>& points, const SDL_Color& color, BlitFlags flags) override;
 
@@ -28,6 +28,10 @@
 
 using namespace GemRB;
 
+// limits on the work FlushBlits does for each blit
+static const size_t MAX_QUEUED_BLITS = 4096;
+static const size_t MAX_GROUP_LOOKBACK = 32;
+
 SDL20VideoDriver::SDL20VideoDriver(void)
 {
 	renderer = NULL;
@@ -52,6 +56,10 @@ SDL20VideoDriver::~SDL20VideoDriver(void)
 		SDL_GameControllerClose(gameController);
 	}
 	
+	// nothing is drawn anymore
+	blitQueue.clear();
+	queuedSprites.clear();
+
 	// we must release all buffers before SDL_DestroyRenderer
 	// we cant rely on the base destructor here
 	scratchBuffer = nullptr;
@@ -62,6 +70,7 @@ SDL20VideoDriver::~SDL20VideoDriver(void)
 
 	delete stencilShader;
 	delete spriteShader;
+	delete paletteShader;
 }
 
 int SDL20VideoDriver::Init()
@@ -177,6 +186,14 @@ int SDL20VideoDriver::CreateSDLDisplay(const char* title)
 		Log(FATAL, "SDL 2 GL Driver", "Can't build shader program: %s", msg.c_str());
 		return GEM_ERROR;
 	}
+
+	paletteShader = GLSLProgram::CreateFromFiles("Shaders/SDLTextureV.glsl", "Shaders/PaletteSpriteF.glsl");
+	if (!paletteShader)
+	{
+		std::string msg = GLSLProgram::GetLastError();
+		Log(FATAL, "SDL 2 GL Driver", "Can't build shader program: %s", msg.c_str());
+		return GEM_ERROR;
+	}
 #endif
 
 	// we set logical size so that platforms where the window can be a diffrent size then requested
@@ -201,11 +218,12 @@ VideoBuffer* SDL20VideoDriver::NewVideoBuffer(const Region& r, BufferFormat fmt)
 		Log(ERROR, "SDL 2", "%s", SDL_GetError());
 		return nullptr;
 	}
-	return new SDLTextureVideoBuffer(r.origin, tex, fmt, renderer);
+	return new SDLTextureVideoBuffer(r.origin, tex, fmt, renderer, [this]() { FlushBlits(); });
 }
 
 void SDL20VideoDriver::SwapBuffers(VideoBuffers& buffers)
 {
+	FlushBlits();
 	SDL_SetRenderTarget(renderer, NULL);
 	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
 	SDL_RenderClear(renderer);
@@ -267,6 +285,8 @@ int SDL20VideoDriver::UpdateRenderTarget(const Color* color, BlitFlags flags)
 {
 	// TODO: add support for BlitFlags::HALFTRANS, BlitFlags::COLOR_MOD, and others (no use for them ATM)
 
+	FlushBlits();
+
 	SDL_Texture* target = CurrentRenderBuffer();
 
 	assert(target);
@@ -276,14 +296,7 @@ int SDL20VideoDriver::UpdateRenderTarget(const Color* color, BlitFlags flags)
 		return ret;
 	}
 
-	if (screenClip.size == screenSize)
-	{
-		// Some SDL backends complain on having a clip rect of the entire renderer size
-		// I'm not sure if it is an SDL bug; possibly its just 0 based so it is out of bounds?
-		SDL_RenderSetClipRect(renderer, NULL);
-	} else {
-		SDL_RenderSetClipRect(renderer, reinterpret_cast<SDL_Rect*>(&screenClip));
-	}
+	SetClipRect(RectFromRegion(screenClip));
 
 	if (color) {
 		if (flags & BlitFlags::BLENDED) {
@@ -300,13 +313,46 @@ int SDL20VideoDriver::UpdateRenderTarget(const Color* color, BlitFlags flags)
 	return 0;
 }
 
+void SDL20VideoDriver::SetClipRect(const SDL_Rect& clip)
+{
+	if (clip.w == screenSize.w && clip.h == screenSize.h)
+	{
+		// Some SDL backends complain on having a clip rect of the entire renderer size
+		// I'm not sure if it is an SDL bug; possibly its just 0 based so it is out of bounds?
+		SDL_RenderSetClipRect(renderer, NULL);
+	} else {
+		SDL_RenderSetClipRect(renderer, &clip);
+	}
+}
+
 void SDL20VideoDriver::BlitSpriteNativeClipped(const SDLTextureSprite2D* spr, const Region& src, const Region& dst, BlitFlags flags, const SDL_Color* tint)
 {
-	BlitFlags version = BlitFlags::NONE;
-#if !USE_OPENGL_BACKEND
+#if USE_OPENGL_BACKEND
+	if (queuedSprites.count(spr) && spr->IsTextureStale()) {
+		// the queued blits must not see the updated textures
+		FlushBlits();
+	}
+
+	SDL_Texture* tex = nullptr;
+	if (spr->Format().Bpp == 1) {
+		// the shader looks the indices up in the palette, so neither palette
+		// changes nor tints require converting and reuploading the pixels
+		tex = spr->GetIndexTexture(renderer);
+		paletteTexture = spr->GetPaletteTexture();
+	} else {
+		flags &= ~RenderSpriteVersion(spr, BlitFlags::NONE);
+		tex = spr->GetTexture(renderer);
+	}
+
+	if (flags & BLIT_STENCIL_MASK) {
+		BlitSpriteNativeClipped(tex, src, dst, flags, tint);
+	} else {
+		QueueBlit(spr, tex, src, dst, flags, tint);
+	}
+	paletteTexture = 0;
+#else
 	// we need to isolate flags that require software rendering to use as the "version"
-	version = (BlitFlags::GREY | BlitFlags::SEPIA) & flags;
-#endif
+	BlitFlags version = (BlitFlags::GREY | BlitFlags::SEPIA) & flags;
 	// WARNING: software fallback == slow
 	if (spr->Format().Bpp == 1 && (flags & BlitFlags::ALPHA_MOD)) {
 		version |= BlitFlags::ALPHA_MOD;
@@ -317,10 +363,142 @@ void SDL20VideoDriver::BlitSpriteNativeClipped(const SDLTextureSprite2D* spr, co
 
 	SDL_Texture* tex = spr->GetTexture(renderer);
 	BlitSpriteNativeClipped(tex, src, dst, flags, tint);
+#endif
+}
+
+void SDL20VideoDriver::QueueBlit(const SDLTextureSprite2D* spr, SDL_Texture* tex, const Region& src, const Region& dst, BlitFlags flags, const SDL_Color* tint)
+{
+	SDL_Texture* target = CurrentRenderBuffer();
+	if (target != blitTarget || blitQueue.size() >= MAX_QUEUED_BLITS) {
+		FlushBlits();
+		blitTarget = target;
+	}
+
+	QueuedBlit blit;
+	blit.clip = RectFromRegion(screenClip);
+	blit.drect = RectFromRegion(dst);
+	if (!SDL_IntersectRect(&blit.drect, &blit.clip, &blit.area)) {
+		return;
+	}
+
+	blit.sprite = Holder<Sprite2D>(const_cast<SDLTextureSprite2D*>(spr));
+	blit.texture = tex;
+#if USE_OPENGL_BACKEND
+	blit.palette = paletteTexture;
+#endif
+	blit.srect = RectFromRegion(src);
+	blit.flags = flags;
+	blit.tint = tint ? *tint : SDL_Color {0xff, 0xff, 0xff, 0xff};
+
+	queuedSprites.insert(spr);
+	blitQueue.push_back(std::move(blit));
+}
+
+static int GreyMode(BlitFlags flags)
+{
+	if (flags & BlitFlags::GREY) {
+		return 1;
+	} else if (flags & BlitFlags::SEPIA) {
+		return 2;
+	}
+	return 0;
+}
+
+static SDL_BlendMode BlendMode(BlitFlags flags)
+{
+	if (flags & BlitFlags::ADD) {
+		return SDL_BLENDMODE_ADD;
+	} else if (flags & BlitFlags::MULTIPLY) {
+		return SDL_BLENDMODE_MOD;
+	} else if (flags & (BlitFlags::BLENDED | BlitFlags::HALFTRANS)) {
+		return SDL_BLENDMODE_BLEND;
+	}
+	return SDL_BLENDMODE_NONE;
+}
+
+void SDL20VideoDriver::FlushBlits()
+{
+	if (blitQueue.empty()) {
+		return;
+	}
+
+	// everything but the rects, tint and mirroring has to match within a group
+	auto sameState = [](const QueuedBlit& a, const QueuedBlit& b) {
+		return a.texture == b.texture
+#if USE_OPENGL_BACKEND
+			&& a.palette == b.palette
+#endif
+			&& GreyMode(a.flags) == GreyMode(b.flags)
+			&& BlendMode(a.flags) == BlendMode(b.flags)
+			&& SDL_RectEquals(&a.clip, &b.clip);
+	};
+
+	struct BlitGroup {
+		SDL_Rect bounds;
+		std::vector<size_t> blits;
+	};
+	std::vector<BlitGroup> groups;
+
+	auto overlaps = [this](const BlitGroup& group, const SDL_Rect& area) {
+		if (!SDL_HasIntersection(&group.bounds, &area)) return false;
+		for (size_t i : group.blits) {
+			if (SDL_HasIntersection(&blitQueue[i].area, &area)) return true;
+		}
+		return false;
+	};
+
+	// a blit joins the latest group with the same state, as long as it
+	// doesn't overlap anything queued in the groups after that one
+	for (size_t i = 0; i < blitQueue.size(); ++i) {
+		const QueuedBlit& blit = blitQueue[i];
+		BlitGroup* match = nullptr;
+		size_t oldest = groups.size() > MAX_GROUP_LOOKBACK ? groups.size() - MAX_GROUP_LOOKBACK : 0;
+		for (size_t g = groups.size(); g-- > oldest;) {
+			if (sameState(blitQueue[groups[g].blits[0]], blit)) {
+				match = &groups[g];
+				break;
+			}
+			if (overlaps(groups[g], blit.area)) break;
+		}
+
+		if (match) {
+			match->blits.push_back(i);
+			SDL_UnionRect(&match->bounds, &blit.area, &match->bounds);
+		} else {
+			groups.push_back({blit.area, {i}});
+		}
+	}
+
+	SDL_SetRenderTarget(renderer, blitTarget);
+	for (const BlitGroup& group : groups) {
+		const QueuedBlit& first = blitQueue[group.blits[0]];
+		SetClipRect(first.clip);
+#if USE_OPENGL_BACKEND
+		BeginCustomRendering();
+		UseSpriteShader(first.flags, first.palette);
+#endif
+		for (size_t i : group.blits) {
+			const QueuedBlit& blit = blitQueue[i];
+			if (RenderCopy(blit.texture, &blit.srect, &blit.drect, blit.flags, &blit.tint) != 0) {
+				Log(ERROR, "SDLVideo", "%s", SDL_GetError());
+			}
+		}
+#if USE_OPENGL_BACKEND
+		EndCustomRendering();
+#endif
+	}
+	// the clip drawing them in order would have left behind
+	SetClipRect(blitQueue.back().clip);
+
+	blitQueue.clear();
+	queuedSprites.clear();
+	blitTarget = nullptr;
 }
 
 void SDL20VideoDriver::BlitSpriteNativeClipped(SDL_Texture* texSprite, const Region& srgn, const Region& drgn, BlitFlags flags, const SDL_Color* tint)
 {
+	FlushBlits();
+
 	SDL_Rect srect = RectFromRegion(srgn);
 	SDL_Rect drect = RectFromRegion(drgn);
 	
@@ -409,20 +587,42 @@ int SDL20VideoDriver::RenderCopyShaded(SDL_Texture* texture, const SDL_Rect* src
 {
 #if USE_OPENGL_BACKEND
 	BeginCustomRendering();
-	spriteShader->Use();
-	if (flags&BlitFlags::GREY) {
-		spriteShader->SetUniformValue("u_greyMode", 1, 1);
-	} else if (flags&BlitFlags::SEPIA) {
-		spriteShader->SetUniformValue("u_greyMode", 1, 2);
-	} else {
-		spriteShader->SetUniformValue("u_greyMode", 1, 0);
-	}
-
-	spriteShader->SetUniformValue("s_sprite", 1, 0);
+	UseSpriteShader(flags, paletteTexture);
 #else
 	// "shaders" were already applied via software (RenderSpriteVersion)
 	// they had to be applied very first so we could create a texture from the software rendering
 #endif
+	int ret = RenderCopy(texture, srcrect, dstrect, flags, tint);
+#if USE_OPENGL_BACKEND
+	EndCustomRendering();
+#endif
+	return ret;
+}
+
+#if USE_OPENGL_BACKEND
+void SDL20VideoDriver::UseSpriteShader(BlitFlags flags, GLuint palette)
+{
+	GLSLProgram* shader = spriteShader;
+	if (palette) {
+		shader = paletteShader;
+		// SDL only binds to the first unit, the palette goes on the second
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, palette);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	shader->Use();
+	shader->SetUniformValue("u_greyMode", 1, GreyMode(flags));
+	shader->SetUniformValue("s_sprite", 1, 0);
+	if (palette) {
+		shader->SetUniformValue("s_palette", 1, 1);
+	}
+}
+#endif
+
+int SDL20VideoDriver::RenderCopy(SDL_Texture* texture, const SDL_Rect* srcrect,
+								 const SDL_Rect* dstrect, BlitFlags flags, const SDL_Color* tint)
+{
 	Uint8 alpha = SDL_ALPHA_OPAQUE;
 	if (flags & BlitFlags::ALPHA_MOD) {
 		alpha = tint->a;
@@ -440,24 +640,12 @@ int SDL20VideoDriver::RenderCopyShaded(SDL_Texture* texture, const SDL_Rect* src
 		SDL_SetTextureColorMod(texture, 0xff, 0xff, 0xff);
 	}
 	
-	if (flags & BlitFlags::ADD) {
-		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_ADD);
-	} else if (flags & BlitFlags::MULTIPLY) {
-		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_MOD);
-	} else if (flags & (BlitFlags::BLENDED | BlitFlags::HALFTRANS)) {
-		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-	} else {
-		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
-	}
+	SDL_SetTextureBlendMode(texture, BlendMode(flags));
 	
 	SDL_RendererFlip flipflags = (flags&BlitFlags::MIRRORY) ? SDL_FLIP_VERTICAL : SDL_FLIP_NONE;
 	flipflags = static_cast<SDL_RendererFlip>(flipflags | ((flags&BlitFlags::MIRRORX) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE));
 
-	int ret = SDL_RenderCopyEx(renderer, texture, srcrect, dstrect, 0.0, NULL, flipflags);
-#if USE_OPENGL_BACKEND
-	EndCustomRendering();
-#endif
-	return ret;
+	return SDL_RenderCopyEx(renderer, texture, srcrect, dstrect, 0.0, NULL, flipflags);
 }
 
 void SDL20VideoDriver::DrawPointsImp(const std::vector<Point>& points, const Color& color, BlitFlags flags)
@@ -541,6 +729,8 @@ void SDL20VideoDriver::DrawPolygonImp(const Gem_Polygon* poly, const Point& orig
 
 Holder<Sprite2D> SDL20VideoDriver::GetScreenshot(Region r, const VideoBufferPtr& buf)
 {
+	FlushBlits();
+
 	SDL_Rect rect = RectFromRegion(r);
 
 	unsigned int Width = r.w ? r.w : screenSize.w;
@@ -30,6 +30,10 @@
 class GLSLProgram {};
 #endif
 
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
 namespace GemRB {
 
 Uint32 SDLPixelFormatFromBufferFormat(Video::BufferFormat, SDL_Renderer*);
@@ -76,6 +80,9 @@ class SDLTextureVideoBuffer : public VideoBuffer {
 	// this is also used for rendering stencils
 	SDL_Surface* conversionBuffer = nullptr;
 
+	// lets the driver draw the blits it holds back before the texture changes
+	std::function<void()> beforeUpdate;
+
 private:
 	static Region TextureRegion(SDL_Texture* tex, const Point& p) {
 		int w, h;
@@ -84,8 +91,10 @@ private:
 	}
 
 public:
-	SDLTextureVideoBuffer(const Point& p, SDL_Texture* texture, Video::BufferFormat fmt, SDL_Renderer* renderer)
-	: VideoBuffer(TextureRegion(texture, p)), texture(texture), renderer(renderer), inputFormat(SDLPixelFormatFromBufferFormat(fmt, NULL))
+	SDLTextureVideoBuffer(const Point& p, SDL_Texture* texture, Video::BufferFormat fmt, SDL_Renderer* renderer,
+						  std::function<void()> beforeUpdate = nullptr)
+	: VideoBuffer(TextureRegion(texture, p)), texture(texture), renderer(renderer), inputFormat(SDLPixelFormatFromBufferFormat(fmt, NULL)),
+	beforeUpdate(std::move(beforeUpdate))
 	{
 		assert(texture);
 		assert(renderer);
@@ -101,11 +110,13 @@ public:
 	}
 
 	~SDLTextureVideoBuffer() override {
+		if (beforeUpdate) beforeUpdate();
 		SDL_DestroyTexture(texture);
 		SDL_FreeSurface(conversionBuffer);
 	}
 
 	void Clear() override {
+		if (beforeUpdate) beforeUpdate();
 		SDL_SetRenderTarget(renderer, texture);
 		SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
 #if SDL_COMPILEDVERSION == SDL_VERSIONNUM(2, 0, 10)
@@ -120,6 +131,7 @@ public:
 	}
 	
 	void Clear(const SDL_Rect& rgn) {
+		if (beforeUpdate) beforeUpdate();
 		SDL_SetRenderTarget(renderer, texture);
 		SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
 		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
@@ -142,6 +154,7 @@ public:
 	}
 
 	void CopyPixels(const Region& bufDest, const void* pixelBuf, const int* pitch = NULL, ...) override {
+		if (beforeUpdate) beforeUpdate();
 		int sdlpitch = bufDest.w * SDL_BYTESPERPIXEL(nativeFormat);
 		SDL_Rect dest = RectFromRegion(bufDest);
 
@@ -218,6 +231,32 @@ private:
 
 	GLSLProgram* stencilShader = nullptr;
 	GLSLProgram* spriteShader = nullptr;
+	GLSLProgram* paletteShader = nullptr;
+#if USE_OPENGL_BACKEND
+	// set while blitting the index texture of an 8 bit sprite
+	GLuint paletteTexture = 0;
+#endif
+
+	// Sprite blits are held back until something else gets drawn and then
+	// grouped by their texture and render state, so each group needs only
+	// one shader setup. A blit may only move ahead of the ones it doesn't
+	// overlap, so the result is the same as drawing them in order.
+	struct QueuedBlit {
+		Holder<Sprite2D> sprite; // keeps the textures alive
+		SDL_Texture* texture;
+#if USE_OPENGL_BACKEND
+		GLuint palette;
+#endif
+		SDL_Rect srect;
+		SDL_Rect drect;
+		SDL_Rect clip;
+		SDL_Rect area; // what drect can touch
+		BlitFlags flags;
+		SDL_Color tint;
+	};
+	SDL_Texture* blitTarget = nullptr;
+	std::vector<QueuedBlit> blitQueue;
+	std::unordered_set<const Sprite2D*> queuedSprites;
 	
 	SDL_GameController* gameController = nullptr;
 
@@ -280,6 +319,14 @@ private:
 	void BlitSpriteNativeClipped(SDL_Texture* spr, const Region& src, const Region& dst, BlitFlags flags = BlitFlags::NONE, const SDL_Color* tint = NULL);
 
 	int RenderCopyShaded(SDL_Texture*, const SDL_Rect* srcrect, const SDL_Rect* dstrect, BlitFlags flags, const SDL_Color* = NULL);
+#if USE_OPENGL_BACKEND
+	void UseSpriteShader(BlitFlags flags, GLuint palette);
+#endif
+	int RenderCopy(SDL_Texture*, const SDL_Rect* srcrect, const SDL_Rect* dstrect, BlitFlags flags, const SDL_Color* = NULL);
+	void SetClipRect(const SDL_Rect& clip);
+
+	void QueueBlit(const SDLTextureSprite2D* spr, SDL_Texture* tex, const Region& src, const Region& dst, BlitFlags flags, const SDL_Color* tint);
+	void FlushBlits();
 
 	int GetTouchFingers(TouchEvent::Finger(&fingers)[FINGER_MAX], SDL_TouchID device) const;
 };
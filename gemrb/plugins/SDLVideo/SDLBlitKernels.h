@@ -0,0 +1,236 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2021 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef SDL_BLIT_KERNELS_H
+#define SDL_BLIT_KERNELS_H
+
+#include "Video/Pixels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLIT_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace GemRB {
+
+// Row based versions of the RGBBlendingPipeline blits for the common formats:
+// 8 bit paletted or 32 bit sources onto 32 bit targets. They produce the same
+// pixels as the iterator based pipeline, but the formats, the shader and the
+// blend function are resolved once per blit instead of once per pixel.
+
+// a rectangle of pixels, walked row by row in the blit's directions
+struct BlitPlane {
+	uint8_t* pixels = nullptr; // the first pixel to visit
+	int pitch = 0; // bytes to the next row, negative when mirrored vertically
+	int step = 0; // bytes to the next pixel, negative when mirrored horizontally
+
+	BlitPlane() noexcept = default;
+
+	BlitPlane(void* px, int pitch, uint8_t bpp, const Region& rect, bool mirrorX, bool mirrorY) noexcept
+	: pitch(mirrorY ? -pitch : pitch), step(mirrorX ? -bpp : bpp)
+	{
+		pixels = static_cast<uint8_t*>(px) + rect.y * pitch + rect.x * bpp;
+		if (mirrorX) {
+			pixels += (rect.w - 1) * bpp;
+		}
+		if (mirrorY) {
+			pixels += (rect.h - 1) * pitch;
+		}
+	}
+};
+
+struct BlitKernelArgs {
+	Size size;
+	BlitPlane src;
+	BlitPlane dst;
+	BlitPlane stencil; // no stencil if it has no pixels
+	const PixelFormat* srcFormat = nullptr;
+	const PixelFormat* dstFormat = nullptr;
+	uint32_t stencilMask = 0;
+	uint8_t stencilShift = 0;
+};
+
+// whether a format can be read (or written) by the kernels
+inline bool BlitKernelSupports(const PixelFormat& fmt, bool target)
+{
+	if (fmt.RLE) return false;
+	if (fmt.Bpp == 1) {
+		return !target && fmt.palette;
+	}
+	return fmt.Bpp == 4 && fmt.Rloss == 0 && fmt.Gloss == 0 && fmt.Bloss == 0
+		&& (fmt.Amask == 0 || fmt.Aloss == 0);
+}
+
+inline Color BlitKernelRead(uint32_t pixel, const PixelFormat& fmt)
+{
+	Color c((pixel & fmt.Rmask) >> fmt.Rshift, (pixel & fmt.Gmask) >> fmt.Gshift,
+			(pixel & fmt.Bmask) >> fmt.Bshift, 255);
+	if (fmt.Amask) {
+		c.a = (pixel & fmt.Amask) >> fmt.Ashift;
+	} else if (fmt.HasColorKey && pixel == fmt.ColorKey) {
+		c.a = 0;
+	}
+	return c;
+}
+
+inline Color BlitKernelRead(uint8_t pixel, const PixelFormat& fmt)
+{
+	Color c = fmt.palette->col[pixel];
+	if (fmt.HasColorKey && pixel == fmt.ColorKey) {
+		c.a = 0;
+	}
+	return c;
+}
+
+inline uint32_t BlitKernelPixel(const Color& c, const PixelFormat& fmt)
+{
+	return uint32_t(c.r) << fmt.Rshift | uint32_t(c.g) << fmt.Gshift
+		| uint32_t(c.b) << fmt.Bshift | ((uint32_t(c.a) << fmt.Ashift) & fmt.Amask);
+}
+
+template <void (*BLEND)(const Color& src, Color& dst)>
+inline void BlendRow(const Color* src, Color* dst, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		BLEND(src[i], dst[i]);
+	}
+}
+
+#ifdef BLIT_KERNELS_SSE2
+// ShaderBlend<true> for two pixels widened to 16 bits per channel
+inline __m128i BlendPixelPairSSE2(__m128i src, __m128i dst)
+{
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i full = _mm_set1_epi16(255);
+	// alpha is blended as a + (255 - a) * dstA, which is what scaling 255 by a gives
+	const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i x = _mm_mullo_epi16(_mm_or_si128(src, alphaLanes), alpha);
+	__m128i y = _mm_mullo_epi16(dst, _mm_sub_epi16(full, alpha));
+	// DIV255 from ShaderBlend, none of the 16 bit sums can overflow
+	x = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, ones), _mm_srli_epi16(x, 8)), 8);
+	y = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(y, ones), _mm_srli_epi16(y, 8)), 8);
+	return _mm_add_epi16(x, y);
+}
+
+template <>
+inline void BlendRow<ShaderBlend<true>>(const Color* src, Color* dst, int count)
+{
+	static_assert(sizeof(Color) == 4, "Color has to be a packed RGBA quadruple.");
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i lo = BlendPixelPairSSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+		__m128i hi = BlendPixelPairSSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	for (; i < count; ++i) {
+		ShaderBlend<true>(src[i], dst[i]);
+	}
+}
+#endif
+
+// the pipeline skips fully transparent source pixels, so those are never written
+template <typename SRC_PIXEL, typename PIPELINE, void (*BLEND)(const Color& src, Color& dst)>
+void BlitKernel(const BlitKernelArgs& args, const PIPELINE& pipeline)
+{
+	static const int CHUNK = 256;
+	Color srcc[CHUNK];
+	Color dstc[CHUNK];
+	bool visible[CHUNK];
+
+	const PixelFormat& srcFmt = *args.srcFormat;
+	const PixelFormat& dstFmt = *args.dstFormat;
+	const uint8_t* srcRow = args.src.pixels;
+	uint8_t* dstRow = args.dst.pixels;
+	const uint8_t* stencilRow = args.stencil.pixels;
+
+	for (int y = 0; y < args.size.h; ++y) {
+		const uint8_t* src = srcRow;
+		uint8_t* dst = dstRow;
+		const uint8_t* stencil = stencilRow;
+
+		for (int x = 0; x < args.size.w; x += CHUNK) {
+			int count = std::min(CHUNK, args.size.w - x);
+			bool anyVisible = false;
+			uint8_t* chunkDst = dst;
+
+			for (int i = 0; i < count; ++i) {
+				SRC_PIXEL px;
+				memcpy(&px, src, sizeof(px));
+				Color c = BlitKernelRead(px, srcFmt);
+				visible[i] = c.a != 0;
+				anyVisible |= visible[i];
+
+				uint8_t mask = 0;
+				if (stencil) {
+					uint32_t spx;
+					memcpy(&spx, stencil, sizeof(spx));
+					mask = (spx & args.stencilMask) >> args.stencilShift;
+					stencil += args.stencil.step;
+				}
+				srcc[i] = pipeline.Shade(c, mask);
+
+				uint32_t dpx;
+				memcpy(&dpx, dst, sizeof(dpx));
+				dstc[i] = BlitKernelRead(dpx, dstFmt);
+
+				src += args.src.step;
+				dst += args.dst.step;
+			}
+
+			if (!anyVisible) continue;
+			BlendRow<BLEND>(srcc, dstc, count);
+
+			for (int i = 0; i < count; ++i, chunkDst += args.dst.step) {
+				if (!visible[i]) continue;
+				uint32_t dpx = BlitKernelPixel(dstc[i], dstFmt);
+				memcpy(chunkDst, &dpx, sizeof(dpx));
+			}
+		}
+
+		srcRow += args.src.pitch;
+		dstRow += args.dst.pitch;
+		if (stencilRow) {
+			stencilRow += args.stencil.pitch;
+		}
+	}
+}
+
+// runs the kernel for the source's pixel size
+template <typename PIPELINE, void (*BLEND)(const Color& src, Color& dst)>
+void BlitKernel(const BlitKernelArgs& args, const PIPELINE& pipeline)
+{
+	if (args.srcFormat->Bpp == 1) {
+		BlitKernel<uint8_t, PIPELINE, BLEND>(args, pipeline);
+	} else {
+		BlitKernel<uint32_t, PIPELINE, BLEND>(args, pipeline);
+	}
+}
+
+}
+
+#endif // SDL_BLIT_KERNELS_H
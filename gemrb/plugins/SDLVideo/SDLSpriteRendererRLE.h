@@ -193,16 +193,65 @@ void SRBlender<Uint32, SRBlender_Alpha>::operator()(Uint32& pix, Uint8 r, Uint8
 	pix = (r << fmt.Rshift) | (g << fmt.Gshift) | (b << fmt.Bshift);
 }
 
-// these always change together
-#define ADVANCE_ITERATORS(count) dest.Advance(count); cover.Advance(count);
+// walks the target (and the stencil) of an RLE blit in the directions of the blit;
+// unlike the generic pixel iterators it only needs to do any math when a run
+// crosses into another row, so skipping a transparent run is a single step
+template<typename PTYPE>
+class RLESpanCursor {
+	BlitPlane target;
+	BlitPlane stencil;
+	Uint32 stencilMask;
+	Uint8 stencilShift;
+	Size size;
+	Uint8* row;
+	const Uint8* stencilRow;
+	int x = 0;
+	int y = 0;
+
+public:
+	RLESpanCursor(const BlitPlane& target, const BlitPlane& stencil, Uint32 stencilMask, Uint8 stencilShift, const Size& size)
+	: target(target), stencil(stencil), stencilMask(stencilMask), stencilShift(stencilShift), size(size),
+	row(target.pixels), stencilRow(stencil.pixels)
+	{}
+
+	bool AtEnd() const {
+		return y >= size.h;
+	}
+
+	void Advance(int count) {
+		x += count;
+		if (x >= size.w) {
+			int rows = x / size.w;
+			x -= rows * size.w;
+			y += rows;
+			row += rows * target.pitch;
+			if (stencilRow) {
+				stencilRow += rows * stencil.pitch;
+			}
+		}
+	}
+
+	PTYPE& Pixel() const {
+		return *reinterpret_cast<PTYPE*>(row + x * target.step);
+	}
+
+	Uint8 Cover() const {
+		if (!stencilRow) return 0;
+		Uint32 px = *reinterpret_cast<const Uint32*>(stencilRow + x * stencil.step);
+		return (px & stencilMask) >> stencilShift;
+	}
+
+	// the position in the target rect, as the pixel iterators would report it
+	Point Position() const {
+		return Point(target.step < 0 ? size.w - 1 - x : x, target.pitch < 0 ? size.h - 1 - y : y);
+	}
+};
 
 template<typename PTYPE, typename Tinter, typename Blender>
-void TintedBlend(SDLPixelIterator& dest, Uint8 alpha,
+void TintedBlend(PTYPE& pix, Uint8 alpha,
 				 Color col, BlitFlags flags,
 				 const Tinter& tint, const Blender& blend)
 {
-	PTYPE& pix = (PTYPE&)*dest;
-
 	tint(col.r, col.g, col.b, col.a, flags);
 	col.a = col.a - alpha; // FIXME: seems like this should be handled by something else, we shouldn't need the 'alpha' param
 	blend(pix, col.r, col.g, col.b, col.a);
@@ -212,10 +261,11 @@ void TintedBlend(SDLPixelIterator& dest, Uint8 alpha,
 }
 
 template<typename PTYPE, typename Tinter, typename Blender>
-void MaskedTintedBlend(SDLPixelIterator& dest, Uint8 maskval,
+void MaskedTintedBlend(const RLESpanCursor<PTYPE>& dest,
 					   const Color& col, BlitFlags flags,
 					   const Tinter& tint, const Blender& blend)
 {
+	Uint8 maskval = dest.Cover();
 	if (maskval < 0xff) {
 		if ((flags & BlitFlags::STENCIL_DITHER) && maskval == 128) {
 			const Point& pos = dest.Position();
@@ -226,7 +276,7 @@ void MaskedTintedBlend(SDLPixelIterator& dest, Uint8 maskval,
 			}
 		}
 		
-		TintedBlend<PTYPE>(dest, maskval, col, flags, tint, blend);
+		TintedBlend<PTYPE>(dest.Pixel(), maskval, col, flags, tint, blend);
 	}
 }
 
@@ -234,20 +284,19 @@ void MaskedTintedBlend(SDLPixelIterator& dest, Uint8 maskval,
 template<typename PTYPE, typename Tinter, typename Blender>
 static void BlitSpriteRLE_Total(const Uint8* rledata,
 								const Color* pal, Uint8 transindex,
-								SDLPixelIterator& dest, IAlphaIterator& cover,
+								RLESpanCursor<PTYPE>& dest,
 								BlitFlags flags, const Tinter& tint, const Blender& blend)
 {
-	SDLPixelIterator end = SDLPixelIterator::end(dest);
-	while (dest != end) {
+	while (!dest.AtEnd()) {
 		Uint8 p = *rledata++;
 		if (p == transindex) {
 			int count = (*rledata++) + 1;
-			ADVANCE_ITERATORS(count);
+			dest.Advance(count);
 			continue;
 		}
 		
-		MaskedTintedBlend<PTYPE>(dest, *cover, pal[p], flags, tint, blend);
-		ADVANCE_ITERATORS(1);
+		MaskedTintedBlend<PTYPE>(dest, pal[p], flags, tint, blend);
+		dest.Advance(1);
 	}
 }
 
@@ -255,7 +304,7 @@ static void BlitSpriteRLE_Total(const Uint8* rledata,
 template<typename PTYPE, typename Tinter, typename Blender>
 static void BlitSpriteRLE_Partial(const Uint8* rledata, const int pitch, const Region& srect,
 								  const Color* pal, Uint8 transindex,
-								  SDLPixelIterator& dest, IAlphaIterator& cover,
+								  RLESpanCursor<PTYPE>& dest,
 								  BlitFlags flags, const Tinter& tint, const Blender& blend)
 {
 	int count = srect.y * pitch;
@@ -272,11 +321,11 @@ static void BlitSpriteRLE_Partial(const Uint8* rledata, const int pitch, const R
 	const int endx = srect.x + srect.w;
 	const int endy = srect.y + srect.h;
 	for (int y = srect.y; y < endy; ++y) {
-		// We assume 'dest' and 'cover' are setup appropriately to accept 'srect.size'
+		// We assume 'dest' is setup appropriately to accept 'srect.size'
 		
 		if (transQueue >= pitch) {
 			transQueue -= pitch;
-			ADVANCE_ITERATORS(srect.w);
+			dest.Advance(srect.w);
 			continue;
 		}
 		
@@ -298,14 +347,14 @@ static void BlitSpriteRLE_Partial(const Uint8* rledata, const int pitch, const R
 				
 				if (transQueue < segment) {
 					if (advance) {
-						ADVANCE_ITERATORS(transQueue);
+						dest.Advance(transQueue);
 					}
 					
 					x += transQueue;
 					transQueue = 0;
 				} else {
 					if (advance) {
-						ADVANCE_ITERATORS(segment);
+						dest.Advance(segment);
 					}
 
 					transQueue -= segment;
@@ -315,12 +364,17 @@ static void BlitSpriteRLE_Partial(const Uint8* rledata, const int pitch, const R
 				Uint8 p = *rledata++;
 				if (p == transindex) {
 					transQueue = (*rledata++) + 1;
+				} else if (x < srect.x || x >= endx) {
+					++x;
 				} else {
-					if (x >= srect.x && x < endx) {
-						MaskedTintedBlend<PTYPE>(dest, *cover, pal[p], flags, tint, blend);
-						ADVANCE_ITERATORS(1);
+					// draw the whole opaque span at once
+					while (true) {
+						MaskedTintedBlend<PTYPE>(dest, pal[p], flags, tint, blend);
+						dest.Advance(1);
+						++x;
+						if (x >= endx || *rledata == transindex) break;
+						p = *rledata++;
 					}
-					++x;
 				}
 			}
 			
@@ -332,7 +386,7 @@ static void BlitSpriteRLE_Partial(const Uint8* rledata, const int pitch, const R
 template<typename Blender, typename Tinter>
 static void BlitSpriteRLE(Holder<Sprite2D> spr, const Region& srect,
 						  SDL_Surface* dst, const Region& drect,
-						  IAlphaIterator* cover,
+						  const BlitPlane& stencil, Uint32 stencilMask, Uint8 stencilShift,
 						  BlitFlags flags, const Tinter& tint)
 {
 	assert(spr && spr->Format().RLE);
@@ -349,34 +403,31 @@ static void BlitSpriteRLE(Holder<Sprite2D> spr, const Region& srect,
 
 	bool partial = spr->Frame.size != srect.size;
 
-	IPixelIterator::Direction xdir = (flags&BlitFlags::MIRRORX) ? IPixelIterator::Reverse : IPixelIterator::Forward;
-	IPixelIterator::Direction ydir = (flags&BlitFlags::MIRRORY) ? IPixelIterator::Reverse : IPixelIterator::Forward;
+	bool mirrorX = flags & BlitFlags::MIRRORX;
+	bool mirrorY = flags & BlitFlags::MIRRORY;
+	PixelFormat format = PixelFormatForSurface(dst);
+	BlitPlane target(dst->pixels, dst->pitch, format.Bpp, drect, mirrorX, mirrorY);
 
-	auto dstit = MakeSDLPixelIterator(dst, xdir, ydir, drect);
-
-	static StaticAlphaIterator nomask(0);
-	if (cover == nullptr) {
-		cover = &nomask;
-	}
-
-	switch (dstit.format.Bpp) {
+	switch (format.Bpp) {
 		case 4:
 		{
-			SRBlender<Uint32, Blender> blend(dstit.format);
+			SRBlender<Uint32, Blender> blend(format);
+			RLESpanCursor<Uint32> dest(target, stencil, stencilMask, stencilShift, drect.size);
 			if (partial) {
-				BlitSpriteRLE_Partial<Uint32>(rledata, spr->Frame.w, srect, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Partial<Uint32>(rledata, spr->Frame.w, srect, palette->col, ck, dest, flags, tint, blend);
 			} else {
-				BlitSpriteRLE_Total<Uint32>(rledata, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Total<Uint32>(rledata, palette->col, ck, dest, flags, tint, blend);
 			}
 			break;
 		}
 		case 2:
 		{
-			SRBlender<Uint16, Blender> blend(dstit.format);
+			SRBlender<Uint16, Blender> blend(format);
+			RLESpanCursor<Uint16> dest(target, stencil, stencilMask, stencilShift, drect.size);
 			if (partial) {
-				BlitSpriteRLE_Partial<Uint16>(rledata, spr->Frame.w, srect, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Partial<Uint16>(rledata, spr->Frame.w, srect, palette->col, ck, dest, flags, tint, blend);
 			} else {
-				BlitSpriteRLE_Total<Uint16>(rledata, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Total<Uint16>(rledata, palette->col, ck, dest, flags, tint, blend);
 			}
 			break;
 		}
@@ -385,5 +436,3 @@ static void BlitSpriteRLE(Holder<Sprite2D> spr, const Region& srect,
 			break;
 	}
 }
-
-#undef ADVANCE_ITERATORS
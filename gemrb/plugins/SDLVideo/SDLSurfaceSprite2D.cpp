@@ -26,6 +26,9 @@
 
 #include "System/Logging.h"
 
+#include <string>
+#include <vector>
+
 namespace GemRB {
 
 SDLSurfaceSprite2D::SDLSurfaceSprite2D (const Region& rgn, void* px, const PixelFormat& fmt) noexcept
@@ -264,6 +267,11 @@ SDLTextureSprite2D::SDLTextureSprite2D(const Region& rgn, const PixelFormat& fmt
 : SDLSurfaceSprite2D(rgn, fmt)
 {}
 
+// the copy may get its own palette or pixels, so it must not share our textures
+SDLTextureSprite2D::SDLTextureSprite2D(const SDLTextureSprite2D& obj) noexcept
+: SDLSurfaceSprite2D(obj)
+{}
+
 Holder<Sprite2D> SDLTextureSprite2D::copy() const
 {
 	return Holder<Sprite2D>(new SDLTextureSprite2D(*this));
@@ -294,23 +302,105 @@ SDL_Texture* SDLTextureSprite2D::GetTexture(SDL_Renderer* renderer) const
 	}
 	return *texture;
 }
+
+bool SDLTextureSprite2D::IsTextureStale() const
+{
+#if USE_OPENGL_BACKEND
+	if (format.Bpp == 1) {
+		PaletteHolder pal = GetPalette();
+		return staleIndexes || stalePalette || (pal && pal->GetVersion() != paletteTextureVersion);
+	}
+#endif
+	return staleTexture || version != 0;
+}
+
+#if USE_OPENGL_BACKEND
+SDL_Texture* SDLTextureSprite2D::GetIndexTexture(SDL_Renderer* renderer) const
+{
+	assert(format.Bpp == 1);
+
+	if (indexTexture == nullptr) {
+		// interpolated indices are meaningless, the lookup needs the exact ones
+		const char* hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+		std::string quality = hint ? hint : "";
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+		SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, Frame.w, Frame.h);
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, hint ? quality.c_str() : nullptr);
+		indexTexture = MakeHolder<TextureHolder>(tex);
+		staleIndexes = true;
+	}
+
+	if (staleIndexes) {
+		// repeating the index in every channel makes it immune to the channel
+		// swizzling the renderer may do for ARGB textures
+		const SDL_Surface* surf = *original;
+		std::vector<Uint32> texels(Frame.w * Frame.h);
+		for (int y = 0; y < Frame.h; ++y) {
+			const Uint8* row = static_cast<const Uint8*>(surf->pixels) + y * surf->pitch;
+			Uint32* dst = &texels[y * Frame.w];
+			for (int x = 0; x < Frame.w; ++x) {
+				Uint32 alpha = (format.HasColorKey && row[x] == format.ColorKey) ? 0 : 0xff000000;
+				dst[x] = alpha | row[x] * 0x010101;
+			}
+		}
+		SDL_UpdateTexture(*indexTexture, nullptr, texels.data(), Frame.w * sizeof(Uint32));
+		staleIndexes = false;
+	}
+	return *indexTexture;
+}
+
+GLuint SDLTextureSprite2D::GetPaletteTexture() const
+{
+	PaletteHolder pal = GetPalette();
+	assert(pal);
+
+	if (paletteTexture == nullptr) {
+		paletteTexture = MakeHolder<PaletteTextureHolder>();
+		stalePalette = true;
+	}
+
+	if (stalePalette || pal->GetVersion() != paletteTextureVersion) {
+		// SDL keeps track of what is bound to the first unit, so stay off it
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, *paletteTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pal->col);
+		glActiveTexture(GL_TEXTURE0);
+		paletteTextureVersion = pal->GetVersion();
+		stalePalette = false;
+	}
+	return *paletteTexture;
+}
+#endif
 	
 void SDLTextureSprite2D::UnlockSprite() const
 {
 	SDLSurfaceSprite2D::UnlockSprite();
 	staleTexture = true;
+#if USE_OPENGL_BACKEND
+	staleIndexes = true;
+#endif
 }
 
 void SDLTextureSprite2D::UpdatePalette(PaletteHolder pal) noexcept
 {
 	SDLSurfaceSprite2D::UpdatePalette(pal);
 	staleTexture = true;
+#if USE_OPENGL_BACKEND
+	stalePalette = true;
+#endif
 }
 
 void SDLTextureSprite2D::UpdateColorKey(colorkey_t key) noexcept
 {
 	SDLSurfaceSprite2D::UpdateColorKey(key);
 	staleTexture = true;
+#if USE_OPENGL_BACKEND
+	staleIndexes = true;
+#endif
 }
 
 void* SDLTextureSprite2D::NewVersion(version_t version) const
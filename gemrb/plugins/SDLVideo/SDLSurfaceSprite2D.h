@@ -26,6 +26,10 @@
 
 #include <SDL.h>
 
+#if USE_OPENGL_BACKEND
+#include "OpenGLEnv.h"
+#endif
+
 namespace GemRB {
 
 class SDLSurfaceSprite2D : public Sprite2D {
@@ -99,6 +103,25 @@ class SDLTextureSprite2D : public SDLSurfaceSprite2D {
 	mutable Uint32 texFormat = SDL_PIXELFORMAT_UNKNOWN;
 	mutable Holder<TextureHolder> texture;
 	mutable bool staleTexture = false;
+
+#if USE_OPENGL_BACKEND
+	struct PaletteTextureHolder : public Held<PaletteTextureHolder>
+	{
+		GLuint texture = 0;
+
+		PaletteTextureHolder() { glGenTextures(1, &texture); }
+		~PaletteTextureHolder() { glDeleteTextures(1, &texture); }
+
+		operator GLuint () const { return texture; }
+	};
+
+	// 8 bit sprites are uploaded once as indices, the shader applies the palette
+	mutable Holder<TextureHolder> indexTexture;
+	mutable Holder<PaletteTextureHolder> paletteTexture;
+	mutable unsigned short paletteTextureVersion = 0;
+	mutable bool staleIndexes = false;
+	mutable bool stalePalette = false;
+#endif
 	
 	void UpdatePalette(PaletteHolder) noexcept override;
 	void UpdateColorKey(colorkey_t key) noexcept override;
@@ -106,11 +129,20 @@ class SDLTextureSprite2D : public SDLSurfaceSprite2D {
 public:
 	SDLTextureSprite2D(const Region&, void* pixels, const PixelFormat& fmt) noexcept;
 	SDLTextureSprite2D(const Region&, const PixelFormat& fmt) noexcept;
+	SDLTextureSprite2D(const SDLTextureSprite2D& obj) noexcept;
 	Holder<Sprite2D> copy() const override;
 	
 	void UnlockSprite() const override;
 
 	SDL_Texture* GetTexture(SDL_Renderer* renderer) const;
+	// whether drawing the sprite as it is now has to update its existing textures
+	bool IsTextureStale() const;
+#if USE_OPENGL_BACKEND
+	// the palette indices of an 8 bit sprite in every color channel, the color key has an alpha of 0
+	SDL_Texture* GetIndexTexture(SDL_Renderer* renderer) const;
+	// a 256x1 texture of the current palette, only reuploaded when the palette changes
+	GLuint GetPaletteTexture() const;
+#endif
 
 	void* NewVersion(version_t version) const override;
 	void Restore() const override;
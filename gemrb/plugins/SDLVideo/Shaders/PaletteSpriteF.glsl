@@ -0,0 +1,27 @@
+precision highp float;
+
+varying vec2 v_texCoord;
+varying vec4 v_color;
+uniform sampler2D s_sprite;
+uniform sampler2D s_palette;
+
+uniform int u_greyMode;
+
+void main()
+{
+	// every channel of the sprite holds the palette index, alpha is 0 for the color key
+	vec4 index = texture2D(s_sprite, v_texCoord);
+	vec4 color = texture2D(s_palette, vec2((index.r * 255.0 + 0.5) / 256.0, 0.5));
+	color.a *= index.a;
+	color *= v_color;
+
+	if (u_greyMode == 1) {
+		float grey = (color.r + color.g + color.b)*0.333333;
+		gl_FragColor = vec4(grey, grey, grey, color.a);
+	} else if (u_greyMode == 2) {
+		float grey = (color.r + color.g + color.b)*0.333333;
+		gl_FragColor = vec4(grey + (21.0/256.0), grey, max(0.0, grey - (32.0/256.0)), color.a);
+	} else {
+		gl_FragColor = color;
+	}
+}
@@ -26,6 +26,9 @@
 #include "Sprite2D.h"
 #include "Video/Video.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace GemRB;
 
 TISImporter::~TISImporter(void)
@@ -66,24 +69,42 @@ Tile* TISImporter::GetTile(unsigned short* indexes, int count,
 	ani->gameAnimation = true;
 	//the turning crystal in ar3202 (bg1) requires animations to be synced
 	ani->frameIdx = 0;
-	for (int i = 0; i < count; i++) {
-		ani->AddFrame( GetTile( indexes[i] ), i );
-	}
+	Tile* tile;
 	if (secondary) {
-		Animation* sec = new Animation( count );
-		for (int i = 0; i < count; i++) {
-			sec->AddFrame( GetTile( secondary[i] ), i );
+		tile = new Tile( ani, new Animation( count ) );
+	} else {
+		tile = new Tile( ani );
+	}
+	// most tiles of big areas are never scrolled to, so the frames only get
+	// decoded once TileOverlay::Draw gets close to them
+	tile->DeferFrames( this, indexes, count, secondary );
+	return tile;
+}
+
+PaletteHolder TISImporter::SharedPalette(const Color (&cols)[256])
+{
+	// FNV-1a
+	size_t hash = 2166136261U;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(cols);
+	for (size_t i = 0; i < sizeof(cols); i++) {
+		hash = (hash ^ bytes[i]) * 16777619U;
+	}
+
+	std::vector<PaletteHolder>& candidates = palettes[hash];
+	for (const PaletteHolder& pal : candidates) {
+		if (memcmp(pal->col, cols, sizeof(cols)) == 0) {
+			return pal;
 		}
-		return new Tile( ani, sec );
 	}
-	return new Tile( ani );
+
+	PaletteHolder pal = MakeHolder<Palette>();
+	std::copy(cols, cols + 256, pal->col);
+	candidates.push_back(pal);
+	return pal;
 }
 
 Holder<Sprite2D> TISImporter::GetTile(int index)
 {
-	PaletteHolder pal = MakeHolder<Palette>();
-	PixelFormat fmt = PixelFormat::Paletted8Bit(pal);
-	
 	void* pixels = calloc(4096, 1);
 	unsigned long pos = index *(1024+4096) + headerShift;
 	if(str->Size()<pos+1024+4096) {
@@ -95,24 +116,29 @@ Holder<Sprite2D> TISImporter::GetTile(int index)
 		}
 	
 		// original PS:T AR0609 and AR0612 report far more tiles than are actually present :(
+		PaletteHolder pal = MakeHolder<Palette>();
 		pal->col[0].g = 200;
-		return core->GetVideoDriver()->CreateSprite(Region(0,0,64,64), pixels, fmt);
+		return core->GetVideoDriver()->CreateSprite(Region(0,0,64,64), pixels, PixelFormat::Paletted8Bit(pal));
 	}
 	str->Seek( pos, GEM_STREAM_START );
 	Color Col[256];
 	str->Read(&Col, 1024 );
 
+	Color cols[256];
+	bool hasColorKey = false;
+	colorkey_t colorKey = 0;
 	for (int i = 0; i < 256; i++) {
 		// bgra format
-		pal->col[i].r = Col[i].b;
-		pal->col[i].g = Col[i].g;
-		pal->col[i].b = Col[i].r;
-		pal->col[i].a = (Col[i].a) ? Col[i].a : 255; // alpha is unused by the originals but SDL will happily use it
-		if (pal->col[i].g==255 && !pal->col[i].r && !pal->col[i].b) {
-			fmt.HasColorKey = true;
-			fmt.ColorKey = i;
+		cols[i].r = Col[i].b;
+		cols[i].g = Col[i].g;
+		cols[i].b = Col[i].r;
+		cols[i].a = (Col[i].a) ? Col[i].a : 255; // alpha is unused by the originals but SDL will happily use it
+		if (cols[i].g==255 && !cols[i].r && !cols[i].b) {
+			hasColorKey = true;
+			colorKey = i;
 		}
 	}
+	PixelFormat fmt = PixelFormat::Paletted8Bit(SharedPalette(cols), hasColorKey, colorKey);
 	str->Read( pixels, 4096 );
 	return core->GetVideoDriver()->CreateSprite(Region(0,0,64,64), pixels, fmt);
 }
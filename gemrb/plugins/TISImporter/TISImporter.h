@@ -23,6 +23,11 @@
 
 #include "TileSetMgr.h"
 
+#include "Palette.h"
+
+#include <unordered_map>
+#include <vector>
+
 namespace GemRB {
 
 class TISImporter : public TileSetMgr {
@@ -32,14 +37,17 @@ private:
 	ieDword TilesCount = 0;
 	ieDword TilesSectionLen = 0;
 	ieDword TileSize = 0;
+	// tiles with the same colors share a palette, keyed by a hash of them
+	std::unordered_map<size_t, std::vector<PaletteHolder>> palettes;
+
+	PaletteHolder SharedPalette(const Color (&cols)[256]);
 public:
 	TISImporter() = default;
 	~TISImporter(void) override;
 	bool Open(DataStream* stream) override;
 	Tile* GetTile(unsigned short* indexes, int count,
 		unsigned short* secondary = NULL) override;
-	Holder<Sprite2D> GetTile(int index);
-public:
+	Holder<Sprite2D> GetTile(int index) override;
 };
 
 }
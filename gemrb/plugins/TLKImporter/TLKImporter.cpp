@@ -31,6 +31,9 @@
 
 using namespace GemRB;
 
+// journals and record screens go through hundreds at once
+static const size_t RECENT_ENTRIES = 4096;
+
 struct gt_type
 {
 	int type;
@@ -103,6 +106,8 @@ bool TLKImporter::Open(DataStream* stream)
 	}
 	delete str;
 	str = stream;
+	recentEntries.clear();
+	recentIndex.clear();
 	char Signature[8];
 	str->Read( Signature, 8 );
 	if (strncmp( Signature, "TLK\x20V1\x20\x20", 8 ) != 0) {
@@ -388,6 +393,47 @@ String* TLKImporter::GetString(ieStrRef strref, ieDword flags)
 	return string;
 }
 
+const TLKImporter::TLKEntry* TLKImporter::GetEntry(ieStrRef strref)
+{
+	auto it = recentIndex.find(strref);
+	if (it != recentIndex.end()) {
+		recentEntries.splice(recentEntries.begin(), recentEntries, it->second);
+		return &it->second->second;
+	}
+
+	ieDword Volume, Pitch, StrOffset;
+	ieDword l;
+	if (str->Seek( 18 + ( strref * 0x1A ), GEM_STREAM_START ) == GEM_ERROR) {
+		return nullptr;
+	}
+	TLKEntry entry;
+	str->ReadWord(entry.type);
+	str->ReadResRef(entry.sound);
+	// volume and pitch variance fields are known to be unused at minimum in bg1
+	str->ReadDword(Volume);
+	str->ReadDword(Pitch);
+	str->ReadDword(StrOffset);
+	str->ReadDword(l);
+	if (l > 65535) {
+		l = 65535; //safety limit, it could be a dword actually
+	}
+
+	if (entry.type & 1) {
+		entry.text.resize(l);
+		str->Seek( StrOffset + Offset, GEM_STREAM_START );
+		str->Read( &entry.text[0], l );
+	}
+	entry.hasTags = entry.text.find_first_of("<[") != std::string::npos;
+
+	recentEntries.emplace_front(strref, std::move(entry));
+	recentIndex[strref] = recentEntries.begin();
+	if (recentEntries.size() > RECENT_ENTRIES) {
+		recentIndex.erase(recentEntries.back().first);
+		recentEntries.pop_back();
+	}
+	return &recentEntries.front().second;
+}
+
 char* TLKImporter::GetCString(ieStrRef strref, ieDword flags)
 {
 	char* string;
@@ -395,6 +441,7 @@ char* TLKImporter::GetCString(ieStrRef strref, ieDword flags)
 	ieWord type;
 	int Length;
 	ResRef SoundResRef;
+	bool hasTags = true;
 
 	if (empty || strref >= STRREF_START || (strref >= BIO_START && strref <= BIO_END)) {
 		if (OverrideTLK) {
@@ -407,38 +454,22 @@ char* TLKImporter::GetCString(ieStrRef strref, ieDword flags)
 		type = 0;
 		SoundResRef.Reset();
 	} else {
-		ieDword Volume, Pitch, StrOffset;
-		ieDword l;
-		if (str->Seek( 18 + ( strref * 0x1A ), GEM_STREAM_START ) == GEM_ERROR) {
+		const TLKEntry* entry = GetEntry(strref);
+		if (!entry) {
 			return strdup("");
 		}
-		str->ReadWord(type);
-		str->ReadResRef( SoundResRef );
-		// volume and pitch variance fields are known to be unused at minimum in bg1
-		str->ReadDword(Volume);
-		str->ReadDword(Pitch);
-		str->ReadDword(StrOffset);
-		str->ReadDword(l);
-		if (l > 65535) {
-			Length = 65535; //safety limit, it could be a dword actually
-		}
-		else {
-			Length = l;
-		}
-		
-		if (type & 1) {
-			str->Seek( StrOffset + Offset, GEM_STREAM_START );
-			string = ( char * ) malloc( Length + 1 );
-			str->Read( string, Length );
-		} else {
-			Length = 0;
-			string = ( char * ) malloc( 1 );
-		}
-		string[Length] = 0; 
+		type = entry->type;
+		SoundResRef = entry->sound;
+		Length = static_cast<int>(entry->text.size());
+		string = ( char * ) malloc( Length + 1 );
+		memcpy(string, entry->text.data(), Length);
+		string[Length] = 0;
+		// without any, resolving can't change the string
+		hasTags = entry->hasTags;
 	}
 
 	//tagged text, bg1 and iwd don't mark them specifically, all entries are tagged
-	if (core->HasFeature( GF_ALL_STRINGS_TAGGED ) || ( type & 4 )) {
+	if (hasTags && (core->HasFeature( GF_ALL_STRINGS_TAGGED ) || ( type & 4 ))) {
 		//GetNewStringLength will look in string and return true
 		//if the new Length will change due to tokens
 		//if there is no new length, we are done
@@ -477,11 +508,8 @@ StringBlock TLKImporter::GetStringBlock(ieStrRef strref, unsigned int flags)
 	if (empty || strref >= StrRefCount) {
 		return StringBlock();
 	}
-	ieWord type;
-	str->Seek( 18 + ( strref * 0x1A ), GEM_STREAM_START );
-	str->ReadWord(type);
-	ResRef soundRef;
-	str->ReadResRef( soundRef );
+	const TLKEntry* entry = GetEntry(strref);
+	ResRef soundRef = entry ? entry->sound : ResRef();
 	return StringBlock(GetString( strref, flags ), soundRef);
 }
 
@@ -26,6 +26,10 @@
 #include "Variables.h"
 #include "TlkOverride.h"
 
+#include <list>
+#include <string>
+#include <unordered_map>
+
 namespace GemRB {
 
 class TLKImporter : public StringMgr {
@@ -40,6 +44,18 @@ private:
 	Variables gtmap;
 	int charname = 0;
 
+	// raw entries of the tlk itself, which never change; tokens are
+	// still resolved on every request, since their values do change
+	struct TLKEntry {
+		std::string text;
+		ieWord type;
+		ResRef sound;
+		bool hasTags; // any tokens or voice directives
+	};
+	using RecentEntries = std::list<std::pair<ieStrRef, TLKEntry>>;
+	RecentEntries recentEntries;
+	std::unordered_map<ieStrRef, RecentEntries::iterator> recentIndex;
+
 public:
 	TLKImporter(void);
 	~TLKImporter(void) override;
@@ -56,6 +72,8 @@ public:
 	StringBlock GetStringBlock(ieStrRef strref, unsigned int flags = 0) override;
 	bool HasAltTLK() const override;
 private:
+	/** reads the entry of strref, remembering it for later */
+	const TLKEntry* GetEntry(ieStrRef strref);
 	/** resolves day and monthname tokens */
 	void GetMonthName(int dayandmonth);
 	/** replaces tags in dest, don't exceed Length */
@@ -89,7 +89,7 @@ int ZLibManager::Decompress(DataStream* dest, DataStream* source, unsigned int s
 	}
 }
 
-int ZLibManager::Compress(DataStream* dest, DataStream* source) const
+int ZLibManager::Compress(DataStream* dest, DataStream* source, int level) const
 {
 	unsigned char bufferin[INPUTSIZE], bufferout[OUTPUTSIZE];
 	z_stream stream{};
@@ -99,8 +99,7 @@ int ZLibManager::Compress(DataStream* dest, DataStream* source) const
 	stream.zfree = Z_NULL;
 	stream.opaque = Z_NULL;
 
-	//result = deflateInit( &stream, Z_DEFAULT_COMPRESSION );
-	result = deflateInit( &stream, Z_BEST_COMPRESSION );
+	result = deflateInit( &stream, Clamp(level, Z_NO_COMPRESSION, Z_BEST_COMPRESSION) );
 	if (result != Z_OK) {
 		return GEM_ERROR;
 	}